@@ -0,0 +1,231 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.util.Arrays;
+
+/**
+ * OutputStream used by the generator to write the arrays and maps of unknown size with the item count,
+ * and the sized containers (head 0x15, int byte length) with the byte length.
+ * While a container is open, its content is buffered; when the outermost one is closed the buffer is written
+ * with the counted heads (and the sized prefix) inserted at the start of each container (no placeholder, so nothing to compact).
+ * If the buffer reaches maxBufferSize, the containers still open are written with the EOF head if the count
+ * is not known (the generator writes the EOF on close), and the sized ones with a zero length (not skippable).
+ * The buffering stops until the next container.
+ */
+final class YajbeBackPatchOutputStream extends OutputStream {
+  private static final int ARRAY_HEAD = 0b0010_0000;
+  private static final int OBJECT_HEAD = 0b0011_0000;
+  private static final int SIZED_HEAD = 0b0001_0101;
+  private static final int SPILLED_EOF = -1;
+  private static final int SPILLED_COUNTED = -2;
+
+  private final byte[] headBuf = new byte[16];
+  private final OutputStream stream;
+  private final int maxBufferSize;
+
+  private byte[] buf = new byte[4096];
+  private int length;
+
+  // the buffered containers, in open order: the position of the head in the buffer, the head, the count (-1 if unknown),
+  // the byte length (-1 if not sized), the buffer position at close (-1 if open) and the last container opened before the close
+  private int[] positions = new int[16];
+  private int[] heads = new int[16];
+  private int[] counts = new int[16];
+  private int[] lengths = new int[16];
+  private int[] ends = new int[16];
+  private int[] lastNested = new int[16];
+  private int[] inserted = new int[17];
+  private int containerCount;
+
+  // the open containers: the index of the buffered container, or SPILLED_* if the head was already written
+  private int[] openStack = new int[16];
+  private int openCount;
+  private int bufferedOpenCount;
+
+  YajbeBackPatchOutputStream(final OutputStream stream, final int maxBufferSize) {
+    this.stream = stream;
+    this.maxBufferSize = maxBufferSize;
+  }
+
+  void open(final boolean isArray) {
+    open(isArray, -1, false);
+  }
+
+  /**
+   * @param isArray true for an array, false for a map
+   * @param count the number of items, or -1 if not known (written on close)
+   * @param sized true if the container is prefixed by the sized head and its byte length
+   */
+  void open(final boolean isArray, final int count, final boolean sized) {
+    if (containerCount == positions.length) {
+      final int newSize = containerCount * 2;
+      positions = Arrays.copyOf(positions, newSize);
+      heads = Arrays.copyOf(heads, newSize);
+      counts = Arrays.copyOf(counts, newSize);
+      lengths = Arrays.copyOf(lengths, newSize);
+      ends = Arrays.copyOf(ends, newSize);
+      lastNested = Arrays.copyOf(lastNested, newSize);
+      inserted = Arrays.copyOf(inserted, newSize + 1);
+    }
+    if (openCount == openStack.length) {
+      openStack = Arrays.copyOf(openStack, openCount * 2);
+    }
+
+    positions[containerCount] = length;
+    heads[containerCount] = isArray ? ARRAY_HEAD : OBJECT_HEAD;
+    counts[containerCount] = count;
+    lengths[containerCount] = sized ? 0 : -1;
+    ends[containerCount] = -1;
+    openStack[openCount++] = containerCount++;
+    bufferedOpenCount++;
+  }
+
+  /**
+   * @param itemCount the number of items in the container
+   * @return true if the container was written with the EOF head, and the EOF must be written
+   */
+  boolean close(final int itemCount) throws IOException {
+    final int index = openStack[--openCount];
+    if (index < 0) return index == SPILLED_EOF;
+
+    if (counts[index] < 0) counts[index] = itemCount;
+    ends[index] = length;
+    lastNested[index] = containerCount - 1;
+    if (--bufferedOpenCount == 0) {
+      writeBuffered();
+    }
+    return false;
+  }
+
+  @Override
+  public void write(final int b) throws IOException {
+    if (bufferedOpenCount == 0) {
+      stream.write(b);
+      return;
+    }
+
+    ensureCapacity(1);
+    buf[length++] = (byte) b;
+    if (length > maxBufferSize) spill();
+  }
+
+  @Override
+  public void write(final byte[] data, final int off, final int len) throws IOException {
+    if (bufferedOpenCount == 0) {
+      stream.write(data, off, len);
+      return;
+    }
+
+    ensureCapacity(len);
+    System.arraycopy(data, off, buf, length, len);
+    length += len;
+    if (length > maxBufferSize) spill();
+  }
+
+  @Override
+  public void flush() throws IOException {
+    // the buffered data cannot be written until the containers are closed
+    if (bufferedOpenCount == 0) stream.flush();
+  }
+
+  @Override
+  public void close() throws IOException {
+    stream.close();
+  }
+
+  private void spill() throws IOException {
+    for (int i = 0; i < openCount; ++i) {
+      final int index = openStack[i];
+      if (index >= 0) {
+        openStack[i] = (counts[index] < 0) ? SPILLED_EOF : SPILLED_COUNTED;
+      }
+    }
+    bufferedOpenCount = 0;
+    writeBuffered();
+  }
+
+  private void writeBuffered() throws IOException {
+    // the byte length of a sized container includes the heads inserted in the nested ones,
+    // so they are computed from the last container: inserted[i] is the sum of the bytes inserted from i to the end.
+    inserted[containerCount] = 0;
+    for (int i = containerCount - 1; i >= 0; --i) {
+      int size = headSize(counts[i]);
+      if (lengths[i] >= 0) {
+        if (ends[i] >= 0) {
+          lengths[i] = size + (ends[i] - positions[i]) + (inserted[i + 1] - inserted[lastNested[i] + 1]);
+        }
+        size += sizedPrefixSize(lengths[i]);
+      }
+      inserted[i] = inserted[i + 1] + size;
+    }
+
+    int offset = 0;
+    for (int i = 0; i < containerCount; ++i) {
+      stream.write(buf, offset, positions[i] - offset);
+      offset = positions[i];
+
+      int headLen = 0;
+      if (lengths[i] >= 0) {
+        headBuf[headLen++] = (byte) SIZED_HEAD;
+        headLen += YajbeWriter.writeRawInt(headBuf, headLen, lengths[i]);
+      }
+      headLen += writeHead(headBuf, headLen, heads[i], counts[i]);
+      stream.write(headBuf, 0, headLen);
+    }
+    stream.write(buf, offset, length - offset);
+    containerCount = 0;
+    length = 0;
+  }
+
+  /** @return the size of the counted head */
+  static int headSize(final int count) {
+    if (count <= 10) return 1;
+    return 1 + (((32 - Integer.numberOfLeadingZeros(count - 10)) + 7) >> 3);
+  }
+
+  /** @return the size of the sized head and the int byte length */
+  static int sizedPrefixSize(final int length) {
+    if (length <= 25) return (length <= 24) ? 2 : 3;
+    return 2 + (((32 - Integer.numberOfLeadingZeros(length - 25)) + 7) >> 3);
+  }
+
+  private static int writeHead(final byte[] buf, final int off, final int head, final int count) {
+    if (count < 0) {
+      buf[off] = (byte) (head | 0b1111);
+      return 1;
+    }
+    if (count <= 10) {
+      buf[off] = (byte) (head | count);
+      return 1;
+    }
+
+    final int bytes = headSize(count) - 1;
+    buf[off] = (byte) (head | (10 + bytes));
+    YajbeWriter.writeFixed(buf, off + 1, count - 10, bytes);
+    return 1 + bytes;
+  }
+
+  private void ensureCapacity(final int size) {
+    if ((length + size) > buf.length) {
+      buf = Arrays.copyOf(buf, Math.max(buf.length * 2, length + size));
+    }
+  }
+}
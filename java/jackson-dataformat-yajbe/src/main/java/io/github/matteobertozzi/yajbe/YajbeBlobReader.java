@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.file.Path;
+import java.nio.file.StandardOpenOption;
+
+/**
+ * Gives access to the blob region written by {@link YajbeBlobWriter}.
+ * The blobs are returned as read-only views of the region (e.g. a mmap'd file), without copying them.
+ * Use it with {@link YajbeMapper#CONFIG_BLOB_READER}.
+ */
+public final class YajbeBlobReader {
+  private final ByteBuffer region;
+
+  /**
+   * @param region the blob region, the position 0 is the offset 0 of the blobs
+   */
+  public YajbeBlobReader(final ByteBuffer region) {
+    this.region = region.slice().asReadOnlyBuffer();
+  }
+
+  /**
+   * Map the file region starting at the specified offset (e.g. after the document) until the end of the file.
+   * @param path the file containing the blobs
+   * @param offset the offset of the blob region in the file
+   * @return the reader for the mapped region
+   * @throws IOException if the file cannot be mapped
+   */
+  public static YajbeBlobReader map(final Path path, final long offset) throws IOException {
+    try (FileChannel channel = FileChannel.open(path, StandardOpenOption.READ)) {
+      return new YajbeBlobReader(channel.map(FileChannel.MapMode.READ_ONLY, offset, channel.size() - offset));
+    }
+  }
+
+  /** @return the size of the blob region */
+  public long size() {
+    return region.capacity();
+  }
+
+  /**
+   * @param offset the offset of the blob in the region
+   * @param length the length of the blob
+   * @return a read-only view of the blob
+   * @throws IOException if the reference is outside the region
+   */
+  public ByteBuffer get(final long offset, final long length) throws IOException {
+    if (offset < 0 || length < 0 || (offset + length) > region.capacity()) {
+      throw new IOException("invalid blob reference offset " + offset + " length " + length
+        + ", region size " + region.capacity());
+    }
+    return region.slice(Math.toIntExact(offset), Math.toIntExact(length));
+  }
+}
@@ -0,0 +1,133 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.util.ArrayList;
+
+import io.github.matteobertozzi.yajbe.YajbeReader.ByteArraySlice;
+
+/**
+ * Moves the bytes values above a threshold out of the document, into a sidecar region.
+ * The document contains a blob reference (head 0x12, offset, length) instead of the bytes,
+ * so it stays small and cache-friendly for metadata scans.
+ * <ul>
+ *   <li>sidecar stream: the blobs are appended to the stream while the document is encoded (e.g. a separate file)
+ *   <li>deferred: the blobs are kept by reference and written with {@link #writeTo(OutputStream)}
+ *       after the document, so the region can be in the same file (the byte[] must not change until then)
+ * </ul>
+ * The offsets are relative to the start of the blob region, see {@link YajbeBlobReader}.
+ * Use it with {@link YajbeMapper#CONFIG_BLOB_WRITER}.
+ */
+public final class YajbeBlobWriter {
+  private final ArrayList<ByteArraySlice> pending;
+  private final OutputStream sidecar;
+  private final int threshold;
+  private long size;
+
+  /**
+   * The blobs are kept by reference, and written later with {@link #writeTo(OutputStream)}.
+   * @param threshold the min length of the bytes values stored as blob
+   */
+  public YajbeBlobWriter(final int threshold) {
+    this(null, threshold);
+  }
+
+  /**
+   * @param sidecar the stream where the blobs are appended
+   * @param threshold the min length of the bytes values stored as blob
+   */
+  public YajbeBlobWriter(final OutputStream sidecar, final int threshold) {
+    if (threshold <= 0) throw new IllegalArgumentException("expected a threshold greater than zero, got " + threshold);
+    this.pending = (sidecar == null) ? new ArrayList<>() : null;
+    this.sidecar = sidecar;
+    this.threshold = threshold;
+  }
+
+  /** @return the min length of the bytes values stored as blob */
+  public int threshold() {
+    return threshold;
+  }
+
+  /** @return the size of the blob region */
+  public long size() {
+    return size;
+  }
+
+  boolean isBlob(final int length) {
+    return length >= threshold;
+  }
+
+  /**
+   * @return the offset of the blob in the region
+   */
+  long append(final byte[] buf, final int off, final int len) throws IOException {
+    final long offset = size;
+    if (sidecar != null) {
+      sidecar.write(buf, off, len);
+    } else {
+      pending.add(new ByteArraySlice(buf, off, len));
+    }
+    size += len;
+    return offset;
+  }
+
+  /**
+   * @return the offset of the blob in the region
+   */
+  long append(final InputStream data, final int len) throws IOException {
+    if (sidecar == null) {
+      // deferred: the stream cannot be kept by reference, the content is buffered until writeTo()
+      final byte[] buf = data.readNBytes(len);
+      if (buf.length != len) throw new IOException("expected " + len + " bytes, got " + buf.length);
+      return append(buf, 0, len);
+    }
+
+    final long offset = size;
+    final byte[] buf = new byte[Math.min(len, 64 << 10)];
+    int avail = len;
+    while (avail > 0) {
+      final int n = data.read(buf, 0, Math.min(buf.length, avail));
+      if (n < 0) throw new IOException("expected " + len + " bytes, got " + (len - avail));
+      sidecar.write(buf, 0, n);
+      // the size follows the sidecar, even if the stream ends early
+      size += n;
+      avail -= n;
+    }
+    return offset;
+  }
+
+  /**
+   * Write the blobs kept by reference, to be called once the document is written.
+   * The writer is then ready for the next document, with the offsets starting again from zero.
+   * @param stream the stream where the blob region is written
+   * @throws IOException if the stream cannot be written
+   */
+  public void writeTo(final OutputStream stream) throws IOException {
+    if (pending == null) {
+      throw new IllegalStateException("the blobs are already written to the sidecar stream");
+    }
+    for (final ByteArraySlice blob: pending) {
+      stream.write(blob.buf(), blob.off(), blob.len());
+    }
+    pending.clear();
+    size = 0;
+  }
+}
@@ -0,0 +1,363 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+import java.util.function.Predicate;
+
+import com.fasterxml.jackson.core.JsonGenerator;
+import com.fasterxml.jackson.core.JsonParser;
+import com.fasterxml.jackson.core.JsonToken;
+import com.fasterxml.jackson.databind.ObjectMapper;
+
+/**
+ * Per-block statistics of a record file written by {@link YajbeRecordWriter}, used by the scanners
+ * to skip the blocks that cannot match a predicate.
+ * Each block (records for about blockSize bytes) has the min/max of the numeric fields,
+ * and a Bloom filter of the string (or integer) values of the selected fields.
+ * The statistics are collected by the writer (see {@link YajbeRecordWriter#setBlockStats(Collector)}),
+ * while the record is encoded, and stored in a sidecar YAJBE file.
+ * <pre>
+ * final YajbeBlockStats stats = YajbeBlockStats.readFrom(mapper, statsStream);
+ * for (final Block block: stats.select(stats.contains("user.name", "foo").and(stats.range("age", 18, 30)))) {
+ *   // scan the records from block.startOffset() to block.endOffset()
+ * }
+ * </pre>
+ * @param bloomBits the size of the Bloom filters in bits
+ * @param numericFields the key paths (e.g. "user.age") with min/max
+ * @param bloomFields the key paths (e.g. "user.name") with a Bloom filter
+ * @param blocks the statistics of each block, in file order
+ */
+public record YajbeBlockStats (int bloomBits, List<String> numericFields, List<String> bloomFields, List<Block> blocks) {
+  private static final int BLOOM_HASHES = 4;
+
+  /**
+   * @param startOffset the offset of the first record of the block
+   * @param endOffset the offset after the last record of the block
+   * @param recordCount the number of records in the block
+   * @param min the min value of each numeric field (missing if no record of the block has the field)
+   * @param max the max value of each numeric field (missing if no record of the block has the field)
+   * @param bloom the Bloom filter of each bloom field
+   */
+  public record Block (long startOffset, long endOffset, int recordCount,
+      Map<String, Double> min, Map<String, Double> max, Map<String, byte[]> bloom) {
+    /**
+     * @param field the key path
+     * @param minValue the min value of the range (inclusive)
+     * @param maxValue the max value of the range (inclusive)
+     * @return false if no record of the block has a value in the range, true if the block must be scanned.
+     *         The field must be one of the numeric fields, see {@link YajbeBlockStats#range(String, double, double)}
+     */
+    public boolean mayContainRange(final String field, final double minValue, final double maxValue) {
+      final Double blockMin = min.get(field);
+      return blockMin != null && minValue <= max.get(field) && maxValue >= blockMin;
+    }
+
+    /**
+     * @param field the key path
+     * @param value the value (a string or an integer)
+     * @return false if no record of the block has the value, true if the block must be scanned
+     */
+    public boolean mayContain(final String field, final Object value) {
+      final byte[] filter = bloom.get(field);
+      if (filter == null) return true;
+
+      final YajbeContentHash hash = hashKey(YajbeRecordIndex.encodeKey(value));
+      final int bits = filter.length << 3;
+      for (int i = 0; i < BLOOM_HASHES; ++i) {
+        final int index = Math.floorMod(hash.h1() + i * hash.h2(), bits);
+        if ((filter[index >>> 3] & (1 << (index & 7))) == 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+
+  /**
+   * @param field the key path
+   * @param minValue the min value of the range (inclusive)
+   * @param maxValue the max value of the range (inclusive)
+   * @return the predicate of the blocks that may have a value in the range (all the blocks if the field has no stats)
+   */
+  public Predicate<Block> range(final String field, final double minValue, final double maxValue) {
+    if (!numericFields.contains(field)) return block -> true;
+    return block -> block.mayContainRange(field, minValue, maxValue);
+  }
+
+  /**
+   * @param field the key path
+   * @param value the value (a string or an integer)
+   * @return the predicate of the blocks that may have the value (all the blocks if the field has no stats)
+   */
+  public Predicate<Block> contains(final String field, final Object value) {
+    if (!bloomFields.contains(field)) return block -> true;
+    return block -> block.mayContain(field, value);
+  }
+
+  /**
+   * @param filter the block predicate (e.g. using {@link Block#mayContain(String, Object)})
+   * @return the blocks that must be scanned
+   */
+  public List<Block> select(final Predicate<Block> filter) {
+    final ArrayList<Block> selected = new ArrayList<>();
+    for (final Block block: blocks) {
+      if (filter.test(block)) selected.add(block);
+    }
+    return selected;
+  }
+
+  /**
+   * @param mapper the YAJBE mapper
+   * @param stream the stream where the statistics will be written
+   * @throws IOException if the statistics cannot be written
+   */
+  public void writeTo(final ObjectMapper mapper, final OutputStream stream) throws IOException {
+    mapper.writer().without(JsonGenerator.Feature.AUTO_CLOSE_TARGET).writeValue(stream, this);
+  }
+
+  /**
+   * @param mapper the YAJBE mapper
+   * @param stream the stream containing the statistics
+   * @return the statistics
+   * @throws IOException if the statistics cannot be read
+   */
+  public static YajbeBlockStats readFrom(final ObjectMapper mapper, final InputStream stream) throws IOException {
+    return mapper.readValue(stream, YajbeBlockStats.class);
+  }
+
+  private static YajbeContentHash hashKey(final byte[] key) {
+    final YajbeHashOutputStream hashStream = new YajbeHashOutputStream(OutputStream.nullOutputStream());
+    try {
+      hashStream.write(key);
+    } catch (final IOException e) {
+      throw new IllegalStateException(e);
+    }
+    return hashStream.hash();
+  }
+
+  // ====================================================================================================
+  //  Stats collector
+  // ====================================================================================================
+  /**
+   * Node of the key paths tree, used by the generator to track the key path of the values written.
+   */
+  static final class FieldNode {
+    private HashMap<String, FieldNode> children;
+    private String path;
+    private boolean numeric;
+    private boolean bloom;
+
+    FieldNode child(final String name) {
+      return children != null ? children.get(name) : null;
+    }
+
+    private FieldNode addPath(final String field) {
+      FieldNode node = this;
+      for (final String name: field.split("\\.")) {
+        if (node.children == null) node.children = new HashMap<>();
+        node = node.children.computeIfAbsent(name, k -> new FieldNode());
+      }
+      node.path = field;
+      return node;
+    }
+  }
+
+  /**
+   * Collects the statistics of the records, to be attached to a {@link YajbeRecordWriter}.
+   * The values of the fields are collected by the generator while the record is encoded,
+   * the already encoded records (see {@link YajbeRecordWriter#writeRaw(byte[], int, int)}) are walked
+   * token by token without deserializing them.
+   * Only the objects are walked, the values inside arrays are not collected.
+   */
+  public static final class Collector {
+    private final ArrayList<Block> blocks = new ArrayList<>();
+    private final ObjectMapper mapper;
+    private final List<String> numericFields;
+    private final List<String> bloomFields;
+    private final Set<String> objectPaths = new HashSet<>();
+    private final FieldNode root = new FieldNode();
+    private final int blockSize;
+    private final int bloomBits;
+
+    private HashMap<String, Double> blockMin = new HashMap<>();
+    private HashMap<String, Double> blockMax = new HashMap<>();
+    private HashMap<String, byte[]> blockBloom = new HashMap<>();
+    private long blockStart = -1;
+    private long blockEnd;
+    private int blockRecords;
+
+    /**
+     * @param mapper the mapper used to decode the already encoded records
+     * @param numericFields the key paths (e.g. "user.age") with min/max
+     * @param bloomFields the key paths (e.g. "user.name") with a Bloom filter
+     * @param blockSize the minimum size of a block in bytes
+     * @param bloomBits the size of the Bloom filter of each field in bits (multiple of 8)
+     */
+    public Collector(final ObjectMapper mapper, final List<String> numericFields, final List<String> bloomFields,
+        final int blockSize, final int bloomBits) {
+      if (bloomBits <= 0 || (bloomBits & 7) != 0) {
+        throw new IllegalArgumentException("expected bloomBits to be a multiple of 8, got " + bloomBits);
+      }
+      this.mapper = mapper;
+      this.numericFields = List.copyOf(numericFields);
+      this.bloomFields = List.copyOf(bloomFields);
+      this.blockSize = blockSize;
+      this.bloomBits = bloomBits;
+      addObjectPaths(numericFields);
+      addObjectPaths(bloomFields);
+      for (final String field: numericFields) root.addPath(field).numeric = true;
+      for (final String field: bloomFields) root.addPath(field).bloom = true;
+    }
+
+    private void addObjectPaths(final List<String> fields) {
+      for (final String field: fields) {
+        for (int i = field.indexOf('.'); i > 0; i = field.indexOf('.', i + 1)) {
+          objectPaths.add(field.substring(0, i));
+        }
+      }
+    }
+
+    FieldNode root() {
+      return root;
+    }
+
+    void addInt(final FieldNode field, final long value) {
+      if (field.numeric) addNumeric(field.path, value);
+      if (field.bloom) addBloom(field.path, value);
+    }
+
+    void addFloat(final FieldNode field, final double value) {
+      if (field.numeric) addNumeric(field.path, value);
+    }
+
+    void addString(final FieldNode field, final String value) {
+      if (field.bloom) addBloom(field.path, value);
+    }
+
+    /**
+     * Called once the record is written, the values were already collected while encoding it
+     * (or by {@link #collect(byte[], int, int)}).
+     * @param offset the offset of the record
+     * @param recordSize the size of the record (with the framing)
+     */
+    void addRecord(final long offset, final int recordSize) {
+      if (blockStart < 0) blockStart = offset;
+
+      blockRecords++;
+      blockEnd = offset + recordSize;
+      if ((blockEnd - blockStart) >= blockSize) {
+        flushBlock();
+      }
+    }
+
+    /**
+     * Collect the values of an already encoded record.
+     * @param buf the buffer containing the encoded record
+     * @param off the offset of the encoded record in the buffer
+     * @param len the length of the encoded record
+     * @throws IOException if the record cannot be decoded
+     */
+    void collect(final byte[] buf, final int off, final int len) throws IOException {
+      try (JsonParser parser = mapper.createParser(buf, off, len)) {
+        if (parser.nextToken() == JsonToken.START_OBJECT) {
+          collect(parser, null);
+        }
+      }
+    }
+
+    private void collect(final JsonParser parser, final String prefix) throws IOException {
+      while (parser.nextToken() == JsonToken.FIELD_NAME) {
+        // the field name is read from the stream, it must be consumed before the value
+        final String name = parser.getCurrentName();
+        final String path = (prefix != null) ? prefix + '.' + name : name;
+        final JsonToken value = parser.nextToken();
+        if (value == null) return;
+
+        switch (value) {
+          case START_OBJECT -> {
+            if (objectPaths.contains(path)) {
+              collect(parser, path);
+            } else {
+              parser.skipChildren();
+            }
+          }
+          case START_ARRAY -> parser.skipChildren();
+          case VALUE_NUMBER_INT -> {
+            if (numericFields.contains(path)) addNumeric(path, parser.getDoubleValue());
+            if (bloomFields.contains(path) && parser.getNumberType() != JsonParser.NumberType.BIG_INTEGER) {
+              addBloom(path, parser.getLongValue());
+            }
+          }
+          case VALUE_NUMBER_FLOAT -> {
+            if (numericFields.contains(path)) addNumeric(path, parser.getDoubleValue());
+          }
+          case VALUE_STRING -> {
+            if (bloomFields.contains(path)) addBloom(path, parser.getText());
+          }
+          default -> {}
+        }
+      }
+    }
+
+    private void addNumeric(final String field, final double value) {
+      // NaN is never in a range, and with min/max it would make every comparison false
+      if (Double.isNaN(value)) return;
+      blockMin.merge(field, value, Math::min);
+      blockMax.merge(field, value, Math::max);
+    }
+
+    private void addBloom(final String field, final Object value) {
+      final byte[] filter = blockBloom.computeIfAbsent(field, k -> new byte[bloomBits >>> 3]);
+      final YajbeContentHash hash = hashKey(YajbeRecordIndex.encodeKey(value));
+      for (int i = 0; i < BLOOM_HASHES; ++i) {
+        final int index = Math.floorMod(hash.h1() + i * hash.h2(), bloomBits);
+        filter[index >>> 3] |= (byte) (1 << (index & 7));
+      }
+    }
+
+    private void flushBlock() {
+      // the fields never seen have an empty filter, so the block is skipped for any value
+      for (final String field: bloomFields) {
+        blockBloom.computeIfAbsent(field, k -> new byte[bloomBits >>> 3]);
+      }
+      blocks.add(new Block(blockStart, blockEnd, blockRecords, blockMin, blockMax, blockBloom));
+      blockMin = new HashMap<>();
+      blockMax = new HashMap<>();
+      blockBloom = new HashMap<>();
+      blockStart = -1;
+      blockRecords = 0;
+    }
+
+    /**
+     * @return the statistics of the records added so far (the last partial block is closed)
+     */
+    public YajbeBlockStats finish() {
+      if (blockRecords > 0) flushBlock();
+      return new YajbeBlockStats(bloomBits, numericFields, bloomFields, List.copyOf(blocks));
+    }
+  }
+}
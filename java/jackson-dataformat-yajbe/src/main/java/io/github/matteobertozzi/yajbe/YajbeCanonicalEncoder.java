@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.math.BigDecimal;
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+import java.util.Iterator;
+import java.util.Map;
+
+import com.fasterxml.jackson.databind.JsonNode;
+import com.fasterxml.jackson.databind.ObjectMapper;
+import com.fasterxml.jackson.databind.node.POJONode;
+
+/**
+ * Writes the canonical encoding of a value:
+ * <ul>
+ *  <li>map keys sorted by their utf-8 bytes (unsigned order)
+ *  <li>arrays and maps always with the number of items, never EOF terminated
+ *  <li>ints at minimal width, floats as float32 when the value does not lose precision
+ *  <li>no enum mapping, and field names state starting from empty
+ * </ul>
+ * The same value will always produce the same bytes, regardless of the map insertion order.
+ */
+final class YajbeCanonicalEncoder {
+  private final YajbeFieldNameWriter fieldNameWriter;
+  private final ObjectMapper mapper;
+  private final YajbeWriter writer;
+
+  private YajbeCanonicalEncoder(final ObjectMapper mapper, final YajbeWriter writer) {
+    this.fieldNameWriter = new YajbeFieldNameWriter(writer);
+    this.mapper = mapper;
+    this.writer = writer;
+  }
+
+  /**
+   * Write the canonical encoding of the value to the stream
+   * @return the content hash of the bytes written
+   */
+  public static YajbeContentHash encode(final ObjectMapper mapper, final OutputStream stream, final Object value) throws IOException {
+    final YajbeHashOutputStream hashStream = new YajbeHashOutputStream(stream);
+    final YajbeWriter writer = YajbeWriter.forBufferedStream(hashStream, new byte[8192]);
+    new YajbeCanonicalEncoder(mapper, writer).writeValue(value);
+    writer.flush();
+    return hashStream.hash();
+  }
+
+  private void writeValue(final Object value) throws IOException {
+    if (value instanceof final JsonNode node) {
+      writeNode(node);
+    } else {
+      writeNode(mapper.valueToTree(value));
+    }
+  }
+
+  private void writeNode(final JsonNode node) throws IOException {
+    if (node == null) {
+      writer.writeNull();
+      return;
+    }
+
+    switch (node.getNodeType()) {
+      case OBJECT -> writeObject(node);
+      case ARRAY -> writeArray(node);
+      case STRING -> writer.writeString(node.textValue());
+      case BINARY -> {
+        final byte[] data = node.binaryValue();
+        writer.writeBytes(data, 0, data.length);
+      }
+      case NUMBER -> writeNumber(node);
+      case BOOLEAN -> writer.writeBool(node.booleanValue());
+      case POJO -> writeValue(((POJONode) node).getPojo());
+      default -> writer.writeNull();
+    }
+  }
+
+  private void writeArray(final JsonNode node) throws IOException {
+    writer.newArray(node.size());
+    for (final JsonNode item: node) {
+      writeNode(item);
+    }
+  }
+
+  private void writeObject(final JsonNode node) throws IOException {
+    final SortedField[] fields = new SortedField[node.size()];
+    final Iterator<Map.Entry<String, JsonNode>> it = node.fields();
+    for (int i = 0; it.hasNext(); ++i) {
+      final Map.Entry<String, JsonNode> entry = it.next();
+      fields[i] = new SortedField(entry.getKey(), entry.getKey().getBytes(StandardCharsets.UTF_8), entry.getValue());
+    }
+    Arrays.sort(fields, (a, b) -> Arrays.compareUnsigned(a.utf8(), b.utf8()));
+
+    writer.newObject(fields.length);
+    fieldNameWriter.startObject();
+    for (final SortedField field: fields) {
+      fieldNameWriter.write(field.name(), field.utf8());
+      writeNode(field.value());
+    }
+    fieldNameWriter.endObject();
+  }
+
+  private void writeNumber(final JsonNode node) throws IOException {
+    if (node.isIntegralNumber()) {
+      if (node.canConvertToLong()) {
+        writer.writeInt(node.longValue());
+      } else {
+        writer.writeBigInteger(node.bigIntegerValue());
+      }
+    } else if (node.isBigDecimal()) {
+      final BigDecimal value = node.decimalValue();
+      writer.writeBigDecimal(value.signum() == 0 ? BigDecimal.ZERO : value.stripTrailingZeros());
+    } else {
+      final double value = node.doubleValue();
+      if (Double.isNaN(value)) {
+        writer.writeFloat32(Float.NaN);
+      } else if ((double) ((float) value) == value) {
+        writer.writeFloat32((float) value);
+      } else {
+        writer.writeFloat64(value);
+      }
+    }
+  }
+
+  private record SortedField (String name, byte[] utf8, JsonNode value) {}
+}
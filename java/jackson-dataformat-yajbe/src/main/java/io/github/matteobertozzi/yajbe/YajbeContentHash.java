@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.util.HexFormat;
+
+/**
+ * 128bit content hash (murmur3 x64_128, seed 0) of the canonical encoding of a value.
+ * @param h1 the first 64bit of the hash
+ * @param h2 the second 64bit of the hash
+ */
+public record YajbeContentHash (long h1, long h2) {
+  /** @return the 64bit version of the hash */
+  public long asLong() {
+    return h1;
+  }
+
+  /** @return the 16 bytes of the hash, in little-endian order */
+  public byte[] toByteArray() {
+    final byte[] buf = new byte[16];
+    YajbeWriter.writeFixed(buf, 0, h1, 8);
+    YajbeWriter.writeFixed(buf, 8, h2, 8);
+    return buf;
+  }
+
+  /** @return the hex representation of the 16 bytes of the hash */
+  public String toHexString() {
+    return HexFormat.of().formatHex(toByteArray());
+  }
+
+  @Override
+  public String toString() {
+    return toHexString();
+  }
+}
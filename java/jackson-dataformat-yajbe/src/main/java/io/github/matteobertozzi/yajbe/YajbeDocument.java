@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.IOException;
+import java.util.Arrays;
+
+import com.fasterxml.jackson.core.JsonGenerator;
+import com.fasterxml.jackson.databind.JavaType;
+import com.fasterxml.jackson.databind.JsonSerializable;
+import com.fasterxml.jackson.databind.ObjectMapper;
+import com.fasterxml.jackson.databind.SerializerProvider;
+import com.fasterxml.jackson.databind.jsontype.TypeSerializer;
+
+/**
+ * An independently encoded YAJBE document (with its own field names and enum state),
+ * embedded in another document as a length-prefixed value (head 0x13, bytes).
+ * <p>The readers skip it without decoding it, the value is decoded only on {@link #decode(ObjectMapper, Class)}.
+ * A document encoded once can be written many times, without encoding it again.
+ * <pre>
+ * record Envelope (String id, long timestamp, YajbeDocument payload) {}
+ * final Envelope envelope = new Envelope("id", now, YajbeDocument.encode(mapper, payload));
+ * ...
+ * final Payload payload = envelope.payload().decode(mapper, Payload.class);
+ * </pre>
+ */
+public final class YajbeDocument implements JsonSerializable {
+  private final byte[] data;
+
+  private YajbeDocument(final byte[] data) {
+    this.data = data;
+  }
+
+  /**
+   * @param data the encoded document, the array is not copied
+   * @return the document wrapping the encoded data
+   */
+  public static YajbeDocument wrap(final byte[] data) {
+    return new YajbeDocument(data);
+  }
+
+  /**
+   * @param mapper the YAJBE mapper used to encode the value
+   * @param value the value to encode
+   * @return the encoded document
+   * @throws IOException if the value cannot be serialized
+   */
+  public static YajbeDocument encode(final ObjectMapper mapper, final Object value) throws IOException {
+    return new YajbeDocument(mapper.writeValueAsBytes(value));
+  }
+
+  /** @return the encoded document, the array is not copied */
+  public byte[] data() {
+    return data;
+  }
+
+  /**
+   * @param mapper the YAJBE mapper used to decode the value
+   * @param valueType the type of the value
+   * @return the decoded value
+   * @throws IOException if the document cannot be decoded
+   */
+  public <T> T decode(final ObjectMapper mapper, final Class<T> valueType) throws IOException {
+    return mapper.readValue(data, valueType);
+  }
+
+  /**
+   * @param mapper the YAJBE mapper used to decode the value
+   * @param valueType the type of the value
+   * @return the decoded value
+   * @throws IOException if the document cannot be decoded
+   */
+  public <T> T decode(final ObjectMapper mapper, final JavaType valueType) throws IOException {
+    return mapper.readValue(data, valueType);
+  }
+
+  @Override
+  public void serialize(final JsonGenerator gen, final SerializerProvider serializers) throws IOException {
+    if (gen instanceof final YajbeGenerator yajbeGen) {
+      yajbeGen.writeEmbeddedDocument(data);
+    } else {
+      gen.writeBinary(data);
+    }
+  }
+
+  @Override
+  public void serializeWithType(final JsonGenerator gen, final SerializerProvider serializers, final TypeSerializer typeSer) throws IOException {
+    serialize(gen, serializers);
+  }
+
+  @Override
+  public boolean equals(final Object obj) {
+    return (obj instanceof final YajbeDocument other) && Arrays.equals(data, other.data);
+  }
+
+  @Override
+  public int hashCode() {
+    return Arrays.hashCode(data);
+  }
+
+  @Override
+  public String toString() {
+    return "YajbeDocument [" + data.length + " bytes]";
+  }
+}
@@ -0,0 +1,145 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Objects;
+
+import com.fasterxml.jackson.databind.ObjectMapper;
+import com.fasterxml.jackson.databind.ObjectWriter;
+
+import io.github.matteobertozzi.yajbe.YajbeEnumMapping.YajbeEnumLruMappingConfig;
+import io.github.matteobertozzi.yajbe.YajbeEnumMapping.YajbeEnumMappingConfig;
+
+/**
+ * Picks the enum mapping configuration (or enum mapping off) for a stream of values,
+ * by encoding a sample of values with each candidate configuration (size counter only, nothing is written)
+ * and keeping the one with the smallest output. The enum mapping is kept off unless it saves at least
+ * {@code minGain} of the size, so the CPU is not spent on the LRU maintenance when there is no benefit.
+ * <p>Attached to a {@link YajbeStreamWriter} or a {@link YajbeSessionWriter}, the first sampleValues values
+ * are sampled and the sampling is repeated every reevaluateEveryValues values. When the best configuration
+ * changes, the writer switches to it with a reset marker, followed by the new enum config header.
+ * An autotuner keeps the state of one stream, it cannot be shared between writers.
+ */
+public final class YajbeEnumAutotuner {
+  /** LRU sizes from 64 to 4096, with min frequency 1, 2 and 8 */
+  public static final List<YajbeEnumMappingConfig> DEFAULT_CANDIDATES = List.of(
+    new YajbeEnumLruMappingConfig(64, 1), new YajbeEnumLruMappingConfig(64, 2), new YajbeEnumLruMappingConfig(64, 8),
+    new YajbeEnumLruMappingConfig(256, 1), new YajbeEnumLruMappingConfig(256, 2), new YajbeEnumLruMappingConfig(256, 8),
+    new YajbeEnumLruMappingConfig(1024, 1), new YajbeEnumLruMappingConfig(1024, 2), new YajbeEnumLruMappingConfig(1024, 8),
+    new YajbeEnumLruMappingConfig(4096, 1), new YajbeEnumLruMappingConfig(4096, 2), new YajbeEnumLruMappingConfig(4096, 8)
+  );
+
+  private final ArrayList<Object> samples = new ArrayList<>();
+  private final List<YajbeEnumMappingConfig> candidates;
+  private final ObjectWriter writer;
+  private final int sampleValues;
+  private final long reevaluateEveryValues;
+  private final double minGain;
+
+  private YajbeEnumMappingConfig config;
+  private long valueCount;
+
+  /**
+   * Autotuner with the default candidates, sampling the first 1000 values and then every 100k values.
+   * @param mapper the YAJBE mapper used to encode the values
+   */
+  public YajbeEnumAutotuner(final ObjectMapper mapper) {
+    this(mapper.writer(), DEFAULT_CANDIDATES, 1000, 100_000, 0.02);
+  }
+
+  /**
+   * @param writer the writer created by the YAJBE mapper used to encode the values
+   * @param candidates the enum mapping configurations to evaluate (enum mapping off is always evaluated)
+   * @param sampleValues the number of values in each sample
+   * @param reevaluateEveryValues sample again every N values (0 to sample only the first values)
+   * @param minGain the minimum size reduction (e.g. 0.02 for 2%) to pick a configuration over a simpler one
+   */
+  public YajbeEnumAutotuner(final ObjectWriter writer, final List<YajbeEnumMappingConfig> candidates,
+      final int sampleValues, final long reevaluateEveryValues, final double minGain) {
+    if (!(writer.getFactory() instanceof final YajbeFactory factory)) {
+      throw new IllegalArgumentException("expected a writer created by YajbeMapper, got " + writer);
+    }
+    this.writer = writer;
+    this.candidates = List.copyOf(candidates);
+    this.sampleValues = sampleValues;
+    this.reevaluateEveryValues = reevaluateEveryValues;
+    this.minGain = minGain;
+    this.config = factory.enumConfig();
+  }
+
+  /** @return the enum mapping configuration in use (null if the enum mapping is off) */
+  public YajbeEnumMappingConfig config() {
+    return config;
+  }
+
+  /**
+   * Encode the samples with each candidate and return the best configuration.
+   * The candidates are evaluated in order, and a candidate is picked only if it is at least minGain
+   * smaller than the best one found so far (starting with enum mapping off).
+   * @param values the sample values
+   * @return the best configuration, null if the enum mapping should be off
+   * @throws IOException if the values cannot be serialized
+   */
+  public YajbeEnumMappingConfig tune(final List<?> values) throws IOException {
+    YajbeEnumMappingConfig best = null;
+    long bestSize = encodedSize(null, values);
+    for (final YajbeEnumMappingConfig candidate: candidates) {
+      final long size = encodedSize(candidate, values);
+      if (size < bestSize * (1.0 - minGain)) {
+        best = candidate;
+        bestSize = size;
+      }
+    }
+    return best;
+  }
+
+  private long encodedSize(final YajbeEnumMappingConfig candidate, final List<?> values) throws IOException {
+    // the values share the generator, as they share the encoder state in the stream
+    try (YajbeGenerator generator = ((YajbeFactory) writer.getFactory()).createSizeCounterGenerator(candidate)) {
+      for (final Object value: values) {
+        writer.writeValue(generator, value);
+      }
+      return generator.encodedSize();
+    }
+  }
+
+  /**
+   * Called by the writer before encoding each value.
+   * @param value the value that will be encoded
+   * @return true if the configuration changed, the writer must switch to {@link #config()} with a reset
+   * @throws IOException if the samples cannot be serialized
+   */
+  boolean observe(final Object value) throws IOException {
+    final long position = (reevaluateEveryValues > 0) ? (valueCount % reevaluateEveryValues) : valueCount;
+    valueCount++;
+    if (position >= sampleValues) return false;
+
+    samples.add(value);
+    if (samples.size() < sampleValues) return false;
+
+    final YajbeEnumMappingConfig best = tune(samples);
+    samples.clear();
+    if (Objects.equals(best, config)) return false;
+
+    config = best;
+    return true;
+  }
+}
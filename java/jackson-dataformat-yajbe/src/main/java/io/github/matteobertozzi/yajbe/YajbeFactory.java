@@ -46,13 +46,17 @@ public class YajbeFactory extends JsonFactory {
 
   /** the enum mapping configuration that will be passed to the YajbeGenerator */
   private final YajbeEnumMappingConfig enumConfig;
+  /** the optional table used by the YajbeParser to share the decoded strings (not serialized, see readResolve()) */
+  private final transient YajbeStringInternTable stringInternTable;
+  /** the intern table size, used to rebuild an empty table on deserialization (0 if disabled) */
+  private final int internCapacity;
+  private final int internMaxLength;
 
   /**
    * Creates a new YajbeFactory without enum mapping
    */
   public YajbeFactory() {
-    super();
-    this.enumConfig = null;
+    this(null, null);
   }
 
   /**
@@ -60,7 +64,39 @@ public class YajbeFactory extends JsonFactory {
    * @param enumConfig the enum-mapping configuration
    */
   public YajbeFactory(final YajbeEnumMappingConfig enumConfig) {
+    this(enumConfig, null);
+  }
+
+  /**
+   * Creates a new YajbeFactory with the specified enum mapping config and string intern table.
+   * The intern table can be shared between factories, repeated string values will be decoded as the same instance.
+   * @param enumConfig the enum-mapping configuration (can be null)
+   * @param stringInternTable the string intern table used by the parsers (can be null)
+   */
+  public YajbeFactory(final YajbeEnumMappingConfig enumConfig, final YajbeStringInternTable stringInternTable) {
+    super();
     this.enumConfig = enumConfig;
+    this.stringInternTable = stringInternTable;
+    this.internCapacity = (stringInternTable != null) ? stringInternTable.capacity() : 0;
+    this.internMaxLength = (stringInternTable != null) ? stringInternTable.maxLength() : 0;
+  }
+
+  private YajbeFactory(final YajbeFactory src, final YajbeStringInternTable stringInternTable) {
+    super(src, null);
+    this.enumConfig = src.enumConfig;
+    this.stringInternTable = stringInternTable;
+    this.internCapacity = src.internCapacity;
+    this.internMaxLength = src.internMaxLength;
+  }
+
+  /**
+   * The deserialized factory gets a new empty intern table of the same size,
+   * the table is a cache and the sharing with other factories is not preserved.
+   */
+  @Override
+  protected Object readResolve() {
+    final YajbeStringInternTable table = (internCapacity > 0) ? new YajbeStringInternTable(internCapacity, internMaxLength) : null;
+    return new YajbeFactory(this, table);
   }
 
 
@@ -72,7 +108,7 @@ public class YajbeFactory extends JsonFactory {
 
   @Override
   protected YajbeParser _createParser(final InputStream in, final IOContext ctxt) {
-    return new YajbeParser(ctxt, _parserFeatures, _objectCodec, YajbeReader.fromStream(in));
+    return newParser(ctxt, YajbeReader.fromStream(in));
   }
 
   @Override
@@ -88,7 +124,12 @@ public class YajbeFactory extends JsonFactory {
 
   @Override
   protected YajbeParser _createParser(final byte[] data, final int offset, final int len, final IOContext ctxt) {
-    return new YajbeParser(ctxt, _parserFeatures, _objectCodec, YajbeReader.fromBytes(data, offset, len));
+    return newParser(ctxt, YajbeReader.fromBytes(data, offset, len));
+  }
+
+  private YajbeParser newParser(final IOContext ctxt, final YajbeReader reader) {
+    reader.setStringInternTable(stringInternTable);
+    return new YajbeParser(ctxt, _parserFeatures, _objectCodec, reader);
   }
 
   @Override
@@ -100,4 +141,25 @@ public class YajbeFactory extends JsonFactory {
   protected YajbeGenerator _createUTF8Generator(final OutputStream out, final IOContext ctxt) {
     return new YajbeGenerator(ctxt, _generatorFeatures, _objectCodec, out, enumConfig);
   }
+
+  /** @return the enum mapping configuration used by the generators (null if disabled) */
+  YajbeEnumMappingConfig enumConfig() {
+    return enumConfig;
+  }
+
+  /**
+   * @return a generator that does not write anything, used to compute the exact encoded size.
+   */
+  YajbeGenerator createSizeCounterGenerator() {
+    return createSizeCounterGenerator(enumConfig);
+  }
+
+  /**
+   * @param enumConfig the enum mapping configuration to simulate (null to disable)
+   * @return a generator that does not write anything, used to compute the exact encoded size.
+   */
+  YajbeGenerator createSizeCounterGenerator(final YajbeEnumMappingConfig enumConfig) {
+    final IOContext ctxt = _createContext(_createContentReference(null), false);
+    return new YajbeGenerator(ctxt, _generatorFeatures, _objectCodec, YajbeWriter.forSizeCounter(), enumConfig);
+  }
 }
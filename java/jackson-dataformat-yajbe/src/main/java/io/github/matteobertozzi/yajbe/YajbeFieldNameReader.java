@@ -28,8 +28,14 @@ final class YajbeFieldNameReader {
 
   private Object[] indexedNames = new Object[32];
   private int indexedNameCount = 0;
+  private int initialNameCount = 0;
   private ByteArraySlice lastKey;
 
+  // sized containers: the index size and the last key at the start of each open one
+  private int[] scopeIndexSize = new int[8];
+  private ByteArraySlice[] scopeLastKey = new ByteArraySlice[8];
+  private int scopeDepth;
+
   public YajbeFieldNameReader(final YajbeReader reader) {
     this.reader = reader;
   }
@@ -40,18 +46,50 @@ final class YajbeFieldNameReader {
     }
 
     if (indexedNames.length <= (names.length * 2)) {
-      indexedNames = Arrays.copyOf(names, names.length * 2);
+      indexedNames = new Object[names.length * 4];
     }
 
     for (int i = 0; i < names.length; ++i) {
       indexedNames[indexedNameCount++] = new ByteArraySlice(names[i].getBytes(StandardCharsets.UTF_8));
       indexedNames[indexedNameCount++] = names[i];
     }
+    initialNameCount = indexedNameCount;
+  }
+
+  /**
+   * Back to the initial state (only the initial field names indexed), see {@link YajbeWriter#writeReset()}.
+   */
+  void reset() {
+    Arrays.fill(indexedNames, initialNameCount, indexedNameCount, null);
+    indexedNameCount = initialNameCount;
+    lastKey = null;
+  }
+
+  /**
+   * Called when a sized container is started, see {@link YajbeFieldNameWriter#openScope()}.
+   */
+  void openScope() {
+    if (scopeDepth == scopeIndexSize.length) {
+      scopeIndexSize = Arrays.copyOf(scopeIndexSize, scopeDepth + 8);
+      scopeLastKey = Arrays.copyOf(scopeLastKey, scopeDepth + 8);
+    }
+    scopeIndexSize[scopeDepth] = indexedNameCount;
+    scopeLastKey[scopeDepth] = lastKey;
+    scopeDepth++;
+  }
+
+  void closeScope() {
+    --scopeDepth;
+    Arrays.fill(indexedNames, scopeIndexSize[scopeDepth], indexedNameCount, null);
+    indexedNameCount = scopeIndexSize[scopeDepth];
+    lastKey = scopeLastKey[scopeDepth];
+    scopeLastKey[scopeDepth] = null;
   }
 
   public String read() throws IOException {
     final int head = this.reader.read();
     return switch ((head >> 5) & 0b111) {
+      case 0b010, 0b011 -> this.readIntKey(head);
       case 0b100 -> this.readFullFieldName(head);
       case 0b101 -> this.readIndexedFieldName(head);
       case 0b110 -> this.readPrefix(head);
@@ -83,6 +121,20 @@ final class YajbeFieldNameReader {
     return str;
   }
 
+  /**
+   * Int keys are encoded with the int heads (see {@link YajbeGenerator#writeFieldId(long)}).
+   * They are not added to the index and they don't change the last key used for the prefix.
+   */
+  private String readIntKey(final int head) throws IOException {
+    final int w = head & 0b11111;
+    final boolean signed = (head & 0b011_00000) == 0b011_00000;
+    if (w < 24) {
+      return Integer.toString(signed ? -w : (1 + w));
+    }
+    final long v = reader.readFixed(w - 23);
+    return Long.toString(signed ? -(v + 24L) : (25L + v));
+  }
+
   private String readFullFieldName(final int head) throws IOException {
     final int length = this.readLength(head);
     final ByteArraySlice utf8 = this.reader.readNBytes(length);
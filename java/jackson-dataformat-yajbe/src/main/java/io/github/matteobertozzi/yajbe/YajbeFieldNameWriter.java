@@ -20,6 +20,7 @@ package io.github.matteobertozzi.yajbe;
 import java.io.IOException;
 import java.nio.charset.StandardCharsets;
 import java.util.Arrays;
+import java.util.HashMap;
 
 final class YajbeFieldNameWriter {
   private static final int MAX_INDEXED_NAMES = 65819;
@@ -27,9 +28,20 @@ final class YajbeFieldNameWriter {
   private final IndexedHashSet indexedMap = new IndexedHashSet(128);
   private final YajbeWriter stream;
 
+  private String[] initialFieldNames;
   private String lastKey;
   private byte[] lastKeyUtf8;
 
+  private final HashMap<String, ShapeGroup> shapes = new HashMap<>();
+  private ShapeCursor[] cursors = new ShapeCursor[0];
+  private int depth;
+
+  // sized containers: the index size and the last key at the start of each open one
+  private int[] scopeIndexSize = new int[8];
+  private String[] scopeLastKey = new String[8];
+  private byte[][] scopeLastKeyUtf8 = new byte[8][];
+  private int scopeDepth;
+
   public YajbeFieldNameWriter(final YajbeWriter stream) {
     this.stream = stream;
   }
@@ -42,18 +54,74 @@ final class YajbeFieldNameWriter {
     for (int i = 0; i < names.length && i < 65819; ++i) {
       indexedMap.add(names[i]);
     }
+    this.initialFieldNames = names;
+  }
+
+  /**
+   * Back to the initial state (only the initial field names indexed).
+   * The cached shapes contain the encoded indexes, so they are dropped too.
+   */
+  void reset() {
+    indexedMap.clear();
+    if (initialFieldNames != null) {
+      for (int i = 0; i < initialFieldNames.length && i < 65819; ++i) {
+        indexedMap.add(initialFieldNames[i]);
+      }
+    }
+    shapes.clear();
+    lastKey = null;
+    lastKeyUtf8 = null;
+  }
+
+  /**
+   * Called when a sized container is started. The names indexed until {@link #closeScope()} are dropped,
+   * and the last key goes back to the current one: the decoder can skip the container without reading it.
+   */
+  void openScope() {
+    if (scopeDepth == scopeIndexSize.length) {
+      scopeIndexSize = Arrays.copyOf(scopeIndexSize, scopeDepth + 8);
+      scopeLastKey = Arrays.copyOf(scopeLastKey, scopeDepth + 8);
+      scopeLastKeyUtf8 = Arrays.copyOf(scopeLastKeyUtf8, scopeDepth + 8);
+    }
+    scopeIndexSize[scopeDepth] = indexedMap.size();
+    scopeLastKey[scopeDepth] = lastKey;
+    scopeLastKeyUtf8[scopeDepth] = lastKeyUtf8;
+    scopeDepth++;
+  }
+
+  void closeScope() {
+    --scopeDepth;
+    indexedMap.truncate(scopeIndexSize[scopeDepth]);
+    lastKey = scopeLastKey[scopeDepth];
+    lastKeyUtf8 = scopeLastKeyUtf8[scopeDepth];
+    scopeLastKey[scopeDepth] = null;
+    scopeLastKeyUtf8[scopeDepth] = null;
   }
 
   public void write(final String key) throws IOException {
+    write(key, null);
+  }
+
+  /**
+   * @param key the field name
+   * @param cachedUtf8 the utf-8 bytes of the key if already available (e.g. SerializableString), or null
+   */
+  public void write(final String key, final byte[] cachedUtf8) throws IOException {
+    if (depth > 0 && writeFromShape(cursors[depth - 1], key)) {
+      this.lastKey = key;
+      this.lastKeyUtf8 = cachedUtf8;
+      return;
+    }
+
     final int index = this.indexedMap.get(key);
     if (index >= 0) {
       this.writeIndexedFieldName(index);
       this.lastKey = key;
-      this.lastKeyUtf8 = null;
+      this.lastKeyUtf8 = cachedUtf8;
       return;
     }
 
-    final byte[] utf8 = key.getBytes(StandardCharsets.UTF_8);
+    final byte[] utf8 = (cachedUtf8 != null) ? cachedUtf8 : key.getBytes(StandardCharsets.UTF_8);
 
     if (this.lastKey != null && utf8.length > 4) {
       checkPrefixAndWrite(utf8);
@@ -68,6 +136,192 @@ final class YajbeFieldNameWriter {
     this.lastKeyUtf8 = utf8;
   }
 
+  // ====================================================================================================
+  //  Object Shapes
+  // ====================================================================================================
+  // Arrays of objects usually repeat the same sequence of keys, once all the keys are indexed
+  // the encoded field names of the sequence are always the same. The shapes are grouped by first key,
+  // and a matching object copies the encoded bytes of each key without the per-key hash lookup.
+  // A key sequence becomes a shape only once it is seen twice, and the installed shapes are never replaced:
+  // records with the same first key and different keys after it (e.g. "type" variants) don't thrash the cache.
+  private static final int MAX_SHAPES = 256;
+  private static final int MAX_SHAPE_KEYS = 64;
+  private static final int MAX_GROUP_SHAPES = 4;
+  private static final int MAX_GROUP_CANDIDATES = 8;
+
+  private record Shape(String[] keys, byte[] encoded, int[] offsets) {
+    boolean matches(final int index, final String key) {
+      if (index >= keys.length) return false;
+      final String shapeKey = keys[index];
+      return shapeKey == key || shapeKey.equals(key);
+    }
+
+    boolean matchesPrefix(final String[] otherKeys, final int count) {
+      if (count > keys.length) return false;
+      for (int i = 1; i < count; ++i) {
+        if (keys[i] != otherKeys[i] && !keys[i].equals(otherKeys[i])) return false;
+      }
+      return true;
+    }
+  }
+
+  private static final class ShapeGroup {
+    private final Shape[] shapes = new Shape[MAX_GROUP_SHAPES];
+    // key sequences seen once, a shape is built when one is seen again
+    private final String[][] candidates = new String[MAX_GROUP_CANDIDATES][];
+    private int shapeCount;
+    private int nextCandidate;
+
+    private Shape find(final String[] keys, final int index, final String key) {
+      for (int i = 0; i < shapeCount; ++i) {
+        final Shape shape = shapes[i];
+        if (shape.matches(index, key) && shape.matchesPrefix(keys, index)) return shape;
+      }
+      return null;
+    }
+
+    private boolean removeCandidate(final String[] keys, final int count) {
+      for (int i = 0; i < candidates.length; ++i) {
+        final String[] candidate = candidates[i];
+        if (candidate != null && Arrays.equals(candidate, 0, candidate.length, keys, 0, count)) {
+          candidates[i] = null;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    private void addCandidate(final String[] keys, final int count) {
+      candidates[nextCandidate] = Arrays.copyOf(keys, count);
+      nextCandidate = (nextCandidate + 1) % candidates.length;
+    }
+  }
+
+  private static final class ShapeCursor {
+    private final String[] keys = new String[MAX_SHAPE_KEYS];
+    private ShapeGroup group;
+    private Shape shape;
+    private int count;
+    private boolean missed;
+
+    void reset() {
+      this.group = null;
+      this.shape = null;
+      this.count = 0;
+      this.missed = false;
+    }
+
+    void record(final String key) {
+      if (count < MAX_SHAPE_KEYS) keys[count] = key;
+      count++;
+    }
+  }
+
+  /**
+   * Called when an object is started, the keys written until {@link #endObject()}
+   * are matched against the cached shapes (or recorded to build a new one).
+   */
+  void startObject() {
+    if (depth == cursors.length) {
+      cursors = Arrays.copyOf(cursors, depth + 8);
+    }
+    ShapeCursor cursor = cursors[depth];
+    if (cursor == null) {
+      cursor = new ShapeCursor();
+      cursors[depth] = cursor;
+    }
+    cursor.reset();
+    depth++;
+  }
+
+  void endObject() {
+    if (depth == 0) return;
+
+    final ShapeCursor cursor = cursors[--depth];
+    // inside a sized container the shape may contain indexes that are dropped at the end of it
+    if (cursor.missed && cursor.count > 0 && cursor.count <= MAX_SHAPE_KEYS && scopeDepth == 0) {
+      addShape(cursor.keys, cursor.count);
+    }
+  }
+
+  private boolean writeFromShape(final ShapeCursor cursor, final String key) throws IOException {
+    if (cursor.count == 0) {
+      cursor.group = shapes.get(key);
+      cursor.shape = (cursor.group != null && cursor.group.shapeCount > 0) ? cursor.group.shapes[0] : null;
+    }
+
+    final Shape current = cursor.shape;
+    if (current != null) {
+      final int index = cursor.count;
+      // the object is diverging from the shape, look for another one of the group with the same keys so far
+      final Shape shape = current.matches(index, key) ? current : cursor.group.find(current.keys, index, key);
+      if (shape != null) {
+        final int off = shape.offsets[index];
+        stream.write(shape.encoded, off, shape.offsets[index + 1] - off);
+        cursor.shape = shape;
+        cursor.count++;
+        return true;
+      }
+      // no shape matching, keep the keys seen so far
+      System.arraycopy(current.keys, 0, cursor.keys, 0, Math.min(index, MAX_SHAPE_KEYS));
+      cursor.shape = null;
+    }
+    cursor.missed = true;
+    cursor.record(key);
+    return false;
+  }
+
+  private void addShape(final String[] keys, final int count) {
+    ShapeGroup group = shapes.get(keys[0]);
+    if (group == null) {
+      if (shapes.size() >= MAX_SHAPES) return;
+      group = new ShapeGroup();
+      shapes.put(keys[0], group);
+    }
+    if (group.shapeCount == MAX_GROUP_SHAPES) return;
+
+    // the shape is built only when the same key sequence is seen again
+    if (!group.removeCandidate(keys, count)) {
+      group.addCandidate(keys, count);
+      return;
+    }
+
+    final int[] offsets = new int[count + 1];
+    final byte[] buf = new byte[count * 3];
+    int bufOff = 0;
+    for (int i = 0; i < count; ++i) {
+      final int index = indexedMap.get(keys[i]);
+      // the key was not indexed (too many names), the encoding depends on the previous key
+      if (index < 0) return;
+
+      offsets[i] = bufOff;
+      bufOff = writeLength(buf, bufOff, 0b101_00000, index);
+    }
+    offsets[count] = bufOff;
+    group.shapes[group.shapeCount++] = new Shape(Arrays.copyOf(keys, count), Arrays.copyOf(buf, bufOff), offsets);
+  }
+
+  int shapeCount(final String firstKey) {
+    final ShapeGroup group = shapes.get(firstKey);
+    return group != null ? group.shapeCount : 0;
+  }
+
+  private static int writeLength(final byte[] buf, final int off, final int head, final int length) {
+    if (length < 30) {
+      buf[off] = (byte) (head | length);
+      return off + 1;
+    }
+    if (length <= 284) {
+      buf[off] = (byte) (head | 0b11110);
+      buf[off + 1] = (byte) ((length - 29) & 0xff);
+      return off + 2;
+    }
+    buf[off] = (byte) (head | 0b11111);
+    buf[off + 1] = (byte) ((length - 284) / 256);
+    buf[off + 2] = (byte) ((length - 284) & 255);
+    return off + 3;
+  }
+
   private void checkPrefixAndWrite(final byte[] utf8) throws IOException {
     if (lastKeyUtf8 == null) {
       this.lastKeyUtf8 = lastKey.getBytes(StandardCharsets.UTF_8);
@@ -177,6 +431,12 @@ final class YajbeFieldNameWriter {
       return size;
     }
 
+    public void clear() {
+      Arrays.fill(values, 0, size, null);
+      Arrays.fill(buckets, -1);
+      size = 0;
+    }
+
     public void add(final String key) {
       if (size == values.length) {
         resize();
@@ -192,6 +452,20 @@ final class YajbeFieldNameWriter {
       buckets[targetBucket] = keyIndex;
     }
 
+    /**
+     * Remove the keys added after the first newSize. The keys are added at the head of the bucket chain
+     * (and resize() keeps the order), so the last key added is always the first of its bucket.
+     */
+    public void truncate(final int newSize) {
+      final int mask = buckets.length - 1;
+      while (size > newSize) {
+        final int keyIndex = --size;
+        final int itemIndex = keyIndex << 1;
+        buckets[table[itemIndex] & mask] = table[itemIndex + 1];
+        values[keyIndex] = null;
+      }
+    }
+
     public int get(final String key) {
       final int hash = hash(key);
       int index = buckets[hash & (buckets.length - 1)];
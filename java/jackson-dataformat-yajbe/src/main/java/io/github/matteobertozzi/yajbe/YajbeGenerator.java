@@ -18,17 +18,25 @@
 package io.github.matteobertozzi.yajbe;
 
 import java.io.IOException;
+import java.io.InputStream;
 import java.io.OutputStream;
+import java.io.Reader;
 import java.math.BigDecimal;
 import java.math.BigInteger;
 import java.nio.charset.StandardCharsets;
 import java.util.Arrays;
+import java.util.Collection;
+import java.util.Iterator;
+import java.util.Map;
 
 import com.fasterxml.jackson.core.Base64Variant;
 import com.fasterxml.jackson.core.JsonGenerator;
 import com.fasterxml.jackson.core.ObjectCodec;
+import com.fasterxml.jackson.core.SerializableString;
 import com.fasterxml.jackson.core.base.GeneratorBase;
 import com.fasterxml.jackson.core.io.IOContext;
+import com.fasterxml.jackson.databind.JsonNode;
+import com.fasterxml.jackson.databind.node.POJONode;
 
 import io.github.matteobertozzi.yajbe.YajbeEnumMapping.YajbeEnumMappingConfig;
 
@@ -37,7 +45,7 @@ import io.github.matteobertozzi.yajbe.YajbeEnumMapping.YajbeEnumMappingConfig;
  */
 final class YajbeGenerator extends GeneratorBase {
   private final YajbeFieldNameWriter fileNameWriter;
-  private final YajbeEnumMappingConfig enumConfig;
+  private YajbeEnumMappingConfig enumConfig;
   private final YajbeWriter stream;
   private final IOContext ctxt;
   private final byte[] wbuffer;
@@ -52,10 +60,57 @@ final class YajbeGenerator extends GeneratorBase {
     this.enumConfig = enumConfig;
   }
 
+  YajbeGenerator(final IOContext ctxt, final int features, final ObjectCodec codec, final YajbeWriterCounter counter, final YajbeEnumMappingConfig enumConfig) {
+    super(features, codec);
+    this.ctxt = ctxt;
+
+    this.wbuffer = null;
+    this.stream = counter;
+    this.fileNameWriter = new YajbeFieldNameWriter(this.stream);
+    this.enumConfig = enumConfig;
+  }
+
+  /**
+   * @return the number of bytes written so far, only available for generators created with a size counter.
+   */
+  long encodedSize() {
+    if (stream instanceof final YajbeWriterCounter counter) {
+      return counter.size();
+    }
+    throw new UnsupportedOperationException("encodedSize() is only available for the size counter generator");
+  }
+
   void setInitialFieldNames(final String[] names) {
     fileNameWriter.setInitialFieldNames(names);
   }
 
+  /**
+   * Replace the enum mapping configuration (null to disable), must be followed by {@link #writeReset()}
+   * so the encoder and the decoder start a new mapping with the new config header.
+   */
+  void setEnumConfig(final YajbeEnumMappingConfig enumConfig) {
+    this.enumConfig = enumConfig;
+  }
+
+  /**
+   * @return the number of bytes encoded and still in the generator buffer, not yet written to the output stream
+   */
+  int bufferedSize() {
+    return stream.bufferedSize();
+  }
+
+  void setBlobWriter(final YajbeBlobWriter blobWriter) {
+    this.blobWriter = blobWriter;
+  }
+
+  /**
+   * Collect the values of the block stats fields while the record is written, see {@link YajbeRecordWriter}.
+   */
+  void setBlockStats(final YajbeBlockStats.Collector blockStats) {
+    this.blockStats = blockStats;
+    this.statsNodes = new YajbeBlockStats.FieldNode[8];
+  }
+
   @Override
   public void close() throws IOException {
     flush();
@@ -70,7 +125,7 @@ final class YajbeGenerator extends GeneratorBase {
 
   @Override
   protected void _releaseBuffers() {
-    ctxt.releaseWriteEncodingBuffer(wbuffer);
+    if (wbuffer != null) ctxt.releaseWriteEncodingBuffer(wbuffer);
   }
 
   @Override
@@ -78,31 +133,195 @@ final class YajbeGenerator extends GeneratorBase {
     // TODO Auto-generated method stub
   }
 
-  private boolean[] stackBlocks = new boolean[32]; // it can be a bitset (eof required true/false)
+  // ====================================================================================================
+  //  Containers related
+  //  the number of items of each open container is tracked, so the containers of unknown size
+  //  can be written with the count once closed (see setCountedContainers())
+  // ====================================================================================================
+  private static final byte BLOCK_COUNTED = 0;
+  private static final byte BLOCK_EOF = 1;
+  private static final byte BLOCK_BACK_PATCH = 2;
+  private static final byte BLOCK_COUNTER_PATCH = 3;
+  private static final byte BLOCK_SIZED_PATCH = 4;
+  private static final byte BLOCK_SIZED_COUNTER = 5;
+  private static final byte BLOCK_SIZED_COUNTER_PATCH = 6;
+
+  private static final int DEFAULT_SIZED_BUFFER_SIZE = 16 << 20;
+
+  private byte[] stackBlocks = new byte[32];
+  private int[] stackItems = new int[32];
+  private long[] stackStarts = new long[32];
   private int stackSize = 0;
 
+  private YajbeBackPatchOutputStream backPatchStream;
+  private boolean countedContainers;
+  private int sizedMaxDepth;
+  private int sizedDepth;
+
+  /**
+   * The arrays and maps of unknown size (e.g. from iterators) are written with the count instead of the EOF form.
+   * The content of the container is buffered until it is closed, then the exact count is inserted in front of it.
+   * If the buffered data reaches maxBufferSize, the containers still open are written in the EOF form.
+   * The size counter does not buffer anything, it always assumes that the count will be written.
+   * Must be called before writing anything.
+   */
+  void setCountedContainers(final int maxBufferSize) {
+    if (stream instanceof final YajbeWriterStream writerStream) {
+      backPatchStream = new YajbeBackPatchOutputStream(writerStream.outputStream(), maxBufferSize);
+      writerStream.setOutputStream(backPatchStream);
+    }
+    countedContainers = true;
+  }
+
+  /**
+   * The arrays and maps nested up to maxDepth levels below the root are written as sized containers:
+   * head (0x15) and the byte length in front of them, so a reader can skip them without reading the content.
+   * The field names indexed inside a sized container are dropped at the end of it, and the enum mapping
+   * is not used inside it: the state of the decoder is the same whether the container was read or skipped.
+   * The names first seen inside a sized container are written again in the next ones, so the depth should select
+   * the large sub-documents rather than the small items of a long array.
+   * The content is buffered as for {@link #setCountedContainers(int)} (the containers of unknown size get the count too),
+   * if the buffer is full the containers still open are written with a zero length (not skippable).
+   * Must be called before writing anything.
+   */
+  void setSizedContainers(final int maxDepth) {
+    if (backPatchStream == null && stream instanceof final YajbeWriterStream writerStream) {
+      backPatchStream = new YajbeBackPatchOutputStream(writerStream.outputStream(), DEFAULT_SIZED_BUFFER_SIZE);
+      writerStream.setOutputStream(backPatchStream);
+    }
+    countedContainers = true;
+    sizedMaxDepth = maxDepth;
+  }
+
+  private void countItem() {
+    if (stackSize != 0) stackItems[stackSize - 1]++;
+  }
+
   private void openBlock(final boolean eofRequired) {
+    openBlock(eofRequired ? BLOCK_EOF : BLOCK_COUNTED);
+  }
+
+  private void openBlock(final byte blockType) {
     if (stackSize == stackBlocks.length) {
       stackBlocks = Arrays.copyOf(stackBlocks, stackSize + 16);
+      stackItems = Arrays.copyOf(stackItems, stackSize + 16);
+      stackStarts = Arrays.copyOf(stackStarts, stackSize + 16);
     }
-    stackBlocks[stackSize++] = eofRequired;
+    stackBlocks[stackSize] = blockType;
+    stackItems[stackSize] = 0;
+    stackSize++;
+  }
+
+  private boolean isSizedBlock() {
+    return stackSize > 0 && stackSize <= sizedMaxDepth;
+  }
+
+  /**
+   * @param size the number of items, or -1 if not known
+   */
+  private void openSizedBlock(final boolean isArray, final int size) throws IOException {
+    if (backPatchStream != null) {
+      stream.flushBuffer();
+      backPatchStream.open(isArray, size, true);
+      openBlock(BLOCK_SIZED_PATCH);
+    } else {
+      // size counter: the head is counted now, the sized prefix (and the counted head) on close
+      final long start = ((YajbeWriterCounter) stream).size();
+      if (size < 0) {
+        if (isArray) stream.newArray(); else stream.newObject();
+        openBlock(BLOCK_SIZED_COUNTER_PATCH);
+      } else {
+        if (isArray) stream.newArray(size); else stream.newObject(size);
+        openBlock(BLOCK_SIZED_COUNTER);
+      }
+      stackStarts[stackSize - 1] = start;
+    }
+    fileNameWriter.openScope();
+    sizedDepth++;
+  }
+
+  private void openUnknownSizeBlock(final boolean isArray) throws IOException {
+    if (isSizedBlock()) {
+      openSizedBlock(isArray, -1);
+      return;
+    }
+
+    if (backPatchStream != null) {
+      stream.flushBuffer();
+      backPatchStream.open(isArray);
+      openBlock(BLOCK_BACK_PATCH);
+      return;
+    }
+
+    if (isArray) stream.newArray(); else stream.newObject();
+    // size counter: the EOF head is counted now, the difference with the counted head on close
+    openBlock(countedContainers ? BLOCK_COUNTER_PATCH : BLOCK_EOF);
   }
 
   private void closeBlock() throws IOException {
-    if (stackBlocks[--stackSize]) {
-      stream.writeEof();
+    final int itemCount = stackItems[--stackSize];
+    switch (stackBlocks[stackSize]) {
+      case BLOCK_EOF -> stream.writeEof();
+      case BLOCK_BACK_PATCH -> {
+        stream.flushBuffer();
+        if (backPatchStream.close(itemCount)) {
+          stream.writeEof();
+        }
+      }
+      case BLOCK_COUNTER_PATCH -> ((YajbeWriterCounter) stream).addSize(YajbeBackPatchOutputStream.headSize(itemCount) - 1);
+      case BLOCK_SIZED_PATCH -> {
+        stream.flushBuffer();
+        if (backPatchStream.close(itemCount)) {
+          stream.writeEof();
+        }
+        closeSizedScope();
+      }
+      case BLOCK_SIZED_COUNTER, BLOCK_SIZED_COUNTER_PATCH -> {
+        final YajbeWriterCounter counter = (YajbeWriterCounter) stream;
+        if (stackBlocks[stackSize] == BLOCK_SIZED_COUNTER_PATCH) {
+          // the EOF head was counted on open
+          counter.addSize(YajbeBackPatchOutputStream.headSize(itemCount) - 1);
+        }
+        final int length = (int) (counter.size() - stackStarts[stackSize]);
+        counter.addSize(YajbeBackPatchOutputStream.sizedPrefixSize(length));
+        closeSizedScope();
+      }
+      default -> {}
     }
   }
 
+  private void closeSizedScope() {
+    fileNameWriter.closeScope();
+    sizedDepth--;
+  }
+
   @Override
   public void writeStartArray() throws IOException {
-    openBlock(stream.newArray());
+    countItem();
+    if (blockStats != null) statsOpenContainer(false);
+    openUnknownSizeBlock(true);
+  }
+
+  /**
+   * Start an array in the EOF form, without buffering it for the counted/sized containers.
+   * Used for the never-ending arrays, where the values must be written before the end of the array.
+   */
+  void writeStartEofArray() throws IOException {
+    countItem();
+    stream.newArray();
+    openBlock(BLOCK_EOF);
   }
 
   @Override
   public void writeStartArray(final Object forValue, final int size) throws IOException {
+    countItem();
     setCurrentValue(forValue);
-    openBlock(stream.newArray(size));
+    if (blockStats != null) statsOpenContainer(false);
+    if (isSizedBlock()) {
+      openSizedBlock(true, size);
+    } else {
+      openBlock(stream.newArray(size));
+    }
   }
 
   @Override
@@ -112,43 +331,183 @@ final class YajbeGenerator extends GeneratorBase {
 
   @Override
   public void writeArray(final int[] array, final int offset, final int length) throws IOException {
+    countItem();
     stream.writeArray(array, offset, length);
   }
 
   @Override
   public void writeArray(final long[] array, final int offset, final int length) throws IOException {
+    countItem();
     stream.writeArray(array, offset, length);
   }
 
   @Override
   public void writeStartObject() throws IOException {
-    openBlock(stream.newObject());
+    countItem();
+    if (blockStats != null) statsOpenContainer(true);
+    openUnknownSizeBlock(false);
+    fileNameWriter.startObject();
   }
 
   @Override
   public void writeStartObject(final Object forValue, final int size) throws IOException {
+    countItem();
     setCurrentValue(forValue);
-    openBlock(stream.newObject(size));
+    if (blockStats != null) statsOpenContainer(true);
+    if (isSizedBlock()) {
+      openSizedBlock(false, size);
+    } else {
+      openBlock(stream.newObject(size));
+    }
+    fileNameWriter.startObject();
   }
 
   @Override
   public void writeEndObject() throws IOException {
+    fileNameWriter.endObject();
     closeBlock();
   }
 
   @Override
   public void writeFieldName(final String name) throws IOException {
+    if (blockStats != null) statsFieldName(name);
     fileNameWriter.write(name);
   }
 
+  @Override
+  public void writeFieldName(final SerializableString name) throws IOException {
+    // the serializers keep the property names as SerializedString, with the utf-8 bytes cached
+    if (blockStats != null) statsFieldName(name.getValue());
+    fileNameWriter.write(name.getValue(), name.asUnquotedUTF8());
+  }
+
+  @Override
+  public void writeFieldId(final long id) throws IOException {
+    // int keys are written using the int heads, they are not indexed
+    statsField = null;
+    stream.writeInt(id);
+  }
+
+  // ====================================================================================================
+  //  Block stats related
+  // ====================================================================================================
+  // the key path of the values is tracked only through the objects nested in the root object:
+  // statsNodes has the node of each open container (null if not tracked), statsField the node of the current field
+  private YajbeBlockStats.Collector blockStats;
+  private YajbeBlockStats.FieldNode[] statsNodes;
+  private YajbeBlockStats.FieldNode statsField;
+
+  private void statsOpenContainer(final boolean isObject) {
+    if (stackSize == statsNodes.length) {
+      statsNodes = Arrays.copyOf(statsNodes, stackSize + 8);
+    }
+    statsNodes[stackSize] = isObject ? (stackSize == 0 ? blockStats.root() : statsField) : null;
+    statsField = null;
+  }
+
+  private void statsFieldName(final String name) {
+    final YajbeBlockStats.FieldNode parent = (stackSize > 0) ? statsNodes[stackSize - 1] : null;
+    statsField = (parent != null) ? parent.child(name) : null;
+  }
+
+  // ====================================================================================================
+  //  DOM related
+  // ====================================================================================================
+  /**
+   * Walk a JsonNode or Map/Collection tree writing it directly,
+   * maps and arrays are always written with the number of items (no EOF).
+   * The scalars go through the generator write methods (item count, blob writer),
+   * and the integer map keys are written as int keys.
+   * Values that are not part of the DOM (e.g. POJOs in a Map) are written using the codec.
+   */
+  void writeDom(final Object value) throws IOException {
+    if (value == null) {
+      writeNull();
+    } else if (value instanceof final JsonNode node) {
+      writeDomNode(node);
+    } else if (value instanceof final Map<?, ?> map) {
+      writeStartObject(map, map.size());
+      for (final Map.Entry<?, ?> entry: map.entrySet()) {
+        final Object key = entry.getKey();
+        if (key instanceof Integer || key instanceof Long || key instanceof Short || key instanceof Byte) {
+          writeFieldId(((Number) key).longValue());
+        } else {
+          writeFieldName(String.valueOf(key));
+        }
+        writeDom(entry.getValue());
+      }
+      writeEndObject();
+    } else if (value instanceof final Collection<?> collection) {
+      writeStartArray(collection, collection.size());
+      for (final Object item: collection) {
+        writeDom(item);
+      }
+      writeEndArray();
+    } else if (value instanceof final String text) {
+      writeString(text);
+    } else if (value instanceof Integer || value instanceof Long || value instanceof Short || value instanceof Byte) {
+      writeNumber(((Number) value).longValue());
+    } else if (value instanceof final Double v) {
+      writeNumber(v.doubleValue());
+    } else if (value instanceof final Float v) {
+      writeNumber(v.floatValue());
+    } else if (value instanceof final Boolean v) {
+      writeBoolean(v);
+    } else if (value instanceof final byte[] v) {
+      writeBinary(v);
+    } else if (_objectCodec != null) {
+      _objectCodec.writeValue(this, value);
+    } else {
+      throw new IllegalArgumentException("no codec available to write " + value.getClass());
+    }
+  }
+
+  private void writeDomNode(final JsonNode node) throws IOException {
+    switch (node.getNodeType()) {
+      case OBJECT -> {
+        writeStartObject(node, node.size());
+        final Iterator<Map.Entry<String, JsonNode>> it = node.fields();
+        while (it.hasNext()) {
+          final Map.Entry<String, JsonNode> entry = it.next();
+          writeFieldName(entry.getKey());
+          writeDomNode(entry.getValue());
+        }
+        writeEndObject();
+      }
+      case ARRAY -> {
+        writeStartArray(node, node.size());
+        for (final JsonNode item: node) {
+          writeDomNode(item);
+        }
+        writeEndArray();
+      }
+      case STRING -> writeString(node.textValue());
+      case BINARY -> writeBinary(node.binaryValue());
+      case BOOLEAN -> writeBoolean(node.booleanValue());
+      case NUMBER -> {
+        switch (node.numberType()) {
+          case INT, LONG -> writeNumber(node.longValue());
+          case BIG_INTEGER -> writeNumber(node.bigIntegerValue());
+          case FLOAT -> writeNumber(node.floatValue());
+          case DOUBLE -> writeNumber(node.doubleValue());
+          case BIG_DECIMAL -> writeNumber(node.decimalValue());
+        }
+      }
+      case POJO -> writeDom(((POJONode) node).getPojo());
+      default -> writeNull();
+    }
+  }
+
   @Override
   public void writeString(final String text) throws IOException {
+    countItem();
+    if (statsField != null && text != null) blockStats.addString(statsField, text);
     if (text == null || text.isEmpty()) {
       stream.writeEmptyString();
       return;
     }
 
-    if (enumConfig != null && text.length() >= YajbeEnumMapping.MIN_ENUM_STRING_LENGTH) {
+    if (enumConfig != null && sizedDepth == 0 && text.length() >= YajbeEnumMapping.MIN_ENUM_STRING_LENGTH) {
       stream.writeStringOrEnum(enumConfig, text);
     } else {
       stream.writeString(text);
@@ -157,9 +516,11 @@ final class YajbeGenerator extends GeneratorBase {
 
   @Override
   public void writeString(final char[] buffer, final int offset, final int len) throws IOException {
+    countItem();
+    if (statsField != null) blockStats.addString(statsField, new String(buffer, offset, len));
     if (len != 0) {
       final String text = new String(buffer, offset, len);
-      if (enumConfig != null && len >= YajbeEnumMapping.MIN_ENUM_STRING_LENGTH) {
+      if (enumConfig != null && sizedDepth == 0 && len >= YajbeEnumMapping.MIN_ENUM_STRING_LENGTH) {
         stream.writeStringOrEnum(enumConfig, text);
       } else {
         stream.writeString(text);
@@ -176,8 +537,10 @@ final class YajbeGenerator extends GeneratorBase {
 
   @Override
   public void writeUTF8String(final byte[] buffer, final int offset, final int len) throws IOException {
+    countItem();
+    if (statsField != null) blockStats.addString(statsField, new String(buffer, offset, len, StandardCharsets.UTF_8));
     if (len != 0) {
-      if (enumConfig != null && len >= YajbeEnumMapping.MIN_ENUM_STRING_LENGTH) {
+      if (enumConfig != null && sizedDepth == 0 && len >= YajbeEnumMapping.MIN_ENUM_STRING_LENGTH) {
         stream.writeStringOrEnum(enumConfig, new String(buffer, offset, len, StandardCharsets.UTF_8));
       } else {
         stream.writeUtf8(buffer, offset, len);
@@ -209,22 +572,153 @@ final class YajbeGenerator extends GeneratorBase {
 
   @Override
   public void writeBinary(final Base64Variant bv, final byte[] data, final int offset, final int len) throws IOException {
-    stream.writeBytes(data, offset, len);
+    countItem();
+    if (blobWriter != null && blobWriter.isBlob(len)) {
+      writeBlobRef(data, offset, len);
+    } else {
+      stream.writeBytes(data, offset, len);
+    }
+  }
+
+  /**
+   * Write a reset marker, the field names and the enum mapping go back to the initial state
+   * on both the encoder and the decoder side. Must be called between two items (e.g. array items).
+   */
+  void writeReset() throws IOException {
+    fileNameWriter.reset();
+    stream.writeReset();
+  }
+
+  void writeEmbeddedDocument(final byte[] data) throws IOException {
+    countItem();
+    stream.writeEmbeddedDocument(data, 0, data.length);
+  }
+
+  // ====================================================================================================
+  //  Blob reference related
+  // ====================================================================================================
+  private YajbeBlobWriter blobWriter;
+  private long blobCounterSize;
+
+  private void writeBlobRef(final byte[] data, final int offset, final int len) throws IOException {
+    final long blobOffset;
+    if (stream instanceof YajbeWriterCounter) {
+      // size counter, the blob is not written. just compute the offset it will have
+      blobOffset = blobWriter.size() + blobCounterSize;
+      blobCounterSize += len;
+    } else {
+      blobOffset = blobWriter.append(data, offset, len);
+    }
+    stream.writeBlobRef(blobOffset, len);
+  }
+
+  private void writeBlobRef(final InputStream data, final int len) throws IOException {
+    final long blobOffset;
+    if (stream instanceof YajbeWriterCounter) {
+      // size counter, the blob is not written. just compute the offset it will have
+      blobOffset = blobWriter.size() + blobCounterSize;
+      blobCounterSize += len;
+    } else {
+      blobOffset = blobWriter.append(data, len);
+    }
+    stream.writeBlobRef(blobOffset, len);
+  }
+
+  // ====================================================================================================
+  //  Streaming Bytes/String related
+  // ====================================================================================================
+  private static final int CHUNK_SIZE = 64 << 10;
+
+  /**
+   * Write the bytes from the input stream without buffering the full content.
+   * If the length is not known (dataLength &lt; 0) the data is written as chunked bytes.
+   * With a blob writer the data of known length above the threshold goes to the blob region
+   * (e.g. direct or mapped ByteBuffers, that Jackson writes through this method).
+   */
+  @Override
+  public int writeBinary(final Base64Variant bv, final InputStream data, final int dataLength) throws IOException {
+    countItem();
+    if (dataLength >= 0 && blobWriter != null && blobWriter.isBlob(dataLength)) {
+      writeBlobRef(data, dataLength);
+      return dataLength;
+    }
+
+    final byte[] buf = new byte[Math.min(CHUNK_SIZE, dataLength < 0 ? CHUNK_SIZE : Math.max(1, dataLength))];
+    if (dataLength >= 0) {
+      stream.writeBytesHead(dataLength);
+      int avail = dataLength;
+      while (avail > 0) {
+        final int n = data.read(buf, 0, Math.min(buf.length, avail));
+        if (n < 0) throw new IOException("expected " + dataLength + " bytes, got " + (dataLength - avail));
+        stream.write(buf, 0, n);
+        avail -= n;
+      }
+      return dataLength;
+    }
+
+    int length = 0;
+    stream.writeChunkedBytesStart();
+    while (true) {
+      final int n = data.readNBytes(buf, 0, buf.length);
+      if (n <= 0) break;
+      stream.writeChunk(buf, 0, n);
+      length += n;
+    }
+    stream.writeChunkedEnd();
+    return length;
+  }
+
+  /**
+   * Write the text from the reader without buffering the full content.
+   * The utf-8 length is not known upfront, so the text is always written as a chunked string.
+   */
+  @Override
+  public void writeString(final Reader reader, final int len) throws IOException {
+    countItem();
+    final char[] cbuf = new char[CHUNK_SIZE >> 2];
+    stream.writeChunkedStringStart();
+    int pending = 0;
+    int avail = (len < 0) ? Integer.MAX_VALUE : len;
+    while (avail > 0) {
+      final int n = reader.read(cbuf, pending, Math.min(cbuf.length - pending, avail));
+      if (n < 0) break;
+      avail -= n;
+
+      int count = pending + n;
+      // keep the high surrogate for the next chunk, the pair must be encoded together
+      pending = (avail > 0 && Character.isHighSurrogate(cbuf[count - 1])) ? 1 : 0;
+      count -= pending;
+
+      final byte[] utf8 = new String(cbuf, 0, count).getBytes(StandardCharsets.UTF_8);
+      stream.writeChunk(utf8, 0, utf8.length);
+      if (pending != 0) cbuf[0] = cbuf[count];
+    }
+    if (pending != 0) {
+      final byte[] utf8 = String.valueOf(cbuf[0]).getBytes(StandardCharsets.UTF_8);
+      stream.writeChunk(utf8, 0, utf8.length);
+    }
+    stream.writeChunkedEnd();
   }
 
   @Override
   public void writeNumber(final int v) throws IOException {
+    countItem();
+    if (statsField != null) blockStats.addInt(statsField, v);
     stream.writeInt(v);
   }
 
   @Override
   public void writeNumber(final long v) throws IOException {
+    countItem();
+    if (statsField != null) blockStats.addInt(statsField, v);
     stream.writeInt(v);
   }
 
   @Override
   public void writeNumber(final BigInteger v) throws IOException {
+    countItem();
     if (v != null) {
+      if (statsField != null) blockStats.addFloat(statsField, v.doubleValue());
       stream.writeBigInteger(v);
     } else {
       stream.writeNull();
@@ -233,17 +727,23 @@ final class YajbeGenerator extends GeneratorBase {
 
   @Override
   public void writeNumber(final float v) throws IOException {
+    countItem();
+    if (statsField != null) blockStats.addFloat(statsField, v);
     stream.writeFloat32(v);
   }
 
   @Override
   public void writeNumber(final double v) throws IOException {
+    countItem();
+    if (statsField != null) blockStats.addFloat(statsField, v);
     stream.writeFloat64(v);
   }
 
   @Override
   public void writeNumber(final BigDecimal v) throws IOException {
+    countItem();
     if (v != null) {
+      if (statsField != null) blockStats.addFloat(statsField, v.doubleValue());
       stream.writeBigDecimal(v);
     } else {
       stream.writeNull();
@@ -257,11 +757,13 @@ final class YajbeGenerator extends GeneratorBase {
 
   @Override
   public void writeBoolean(final boolean state) throws IOException {
+    countItem();
     stream.writeBool(state);
   }
 
   @Override
   public void writeNull() throws IOException {
+    countItem();
     stream.writeNull();
   }
 }
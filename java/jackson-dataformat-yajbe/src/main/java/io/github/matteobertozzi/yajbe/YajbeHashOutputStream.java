@@ -0,0 +1,131 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.lang.invoke.MethodHandles;
+import java.lang.invoke.VarHandle;
+import java.nio.ByteOrder;
+
+/**
+ * OutputStream that computes the murmur3 x64_128 hash of the data while passing it through.
+ * The hash is computed on the chunks flushed by the writer, so there is no second pass over the data.
+ */
+final class YajbeHashOutputStream extends OutputStream {
+  private static final VarHandle LONG_LE = MethodHandles.byteArrayViewVarHandle(long[].class, ByteOrder.LITTLE_ENDIAN);
+  private static final long C1 = 0x87c37b91114253d5L;
+  private static final long C2 = 0x4cf5ad432745937fL;
+
+  private final byte[] block = new byte[16];
+  private final OutputStream stream;
+  private int blockLength;
+  private long length;
+  private long h1;
+  private long h2;
+
+  YajbeHashOutputStream(final OutputStream stream) {
+    this.stream = stream;
+  }
+
+  @Override
+  public void write(final int b) throws IOException {
+    stream.write(b);
+    length++;
+    block[blockLength++] = (byte) b;
+    if (blockLength == 16) {
+      mixBlock(block, 0);
+      blockLength = 0;
+    }
+  }
+
+  @Override
+  public void write(final byte[] buf, int off, int len) throws IOException {
+    stream.write(buf, off, len);
+    length += len;
+
+    if (blockLength != 0) {
+      final int n = Math.min(16 - blockLength, len);
+      System.arraycopy(buf, off, block, blockLength, n);
+      blockLength += n;
+      off += n;
+      len -= n;
+      if (blockLength < 16) return;
+      mixBlock(block, 0);
+      blockLength = 0;
+    }
+
+    for (; len >= 16; off += 16, len -= 16) {
+      mixBlock(buf, off);
+    }
+
+    if (len > 0) {
+      System.arraycopy(buf, off, block, 0, len);
+      blockLength = len;
+    }
+  }
+
+  @Override
+  public void flush() throws IOException {
+    stream.flush();
+  }
+
+  /** @return the hash of the data written so far */
+  YajbeContentHash hash() {
+    long x1 = h1;
+    long x2 = h2;
+    if (blockLength > 8) {
+      long k2 = YajbeReader.readFixed(block, 8, blockLength - 8);
+      k2 *= C2; k2 = Long.rotateLeft(k2, 33); k2 *= C1; x2 ^= k2;
+    }
+    if (blockLength > 0) {
+      long k1 = YajbeReader.readFixed(block, 0, Math.min(8, blockLength));
+      k1 *= C1; k1 = Long.rotateLeft(k1, 31); k1 *= C2; x1 ^= k1;
+    }
+
+    x1 ^= length;
+    x2 ^= length;
+    x1 += x2;
+    x2 += x1;
+    x1 = fmix64(x1);
+    x2 = fmix64(x2);
+    x1 += x2;
+    x2 += x1;
+    return new YajbeContentHash(x1, x2);
+  }
+
+  private void mixBlock(final byte[] buf, final int off) {
+    long k1 = (long) LONG_LE.get(buf, off);
+    long k2 = (long) LONG_LE.get(buf, off + 8);
+
+    k1 *= C1; k1 = Long.rotateLeft(k1, 31); k1 *= C2; h1 ^= k1;
+    h1 = Long.rotateLeft(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+    k2 *= C2; k2 = Long.rotateLeft(k2, 33); k2 *= C1; h2 ^= k2;
+    h2 = Long.rotateLeft(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+  }
+
+  private static long fmix64(long k) {
+    k ^= k >>> 33;
+    k *= 0xff51afd7ed558ccdL;
+    k ^= k >>> 33;
+    k *= 0xc4ceb9fe1a85ec53L;
+    k ^= k >>> 33;
+    return k;
+  }
+}
@@ -17,6 +17,7 @@
 
 package io.github.matteobertozzi.yajbe;
 
+import java.io.ByteArrayOutputStream;
 import java.io.DataInput;
 import java.io.DataOutput;
 import java.io.File;
@@ -25,7 +26,13 @@ import java.io.InputStream;
 import java.io.OutputStream;
 import java.io.Reader;
 import java.io.Writer;
+import java.math.BigDecimal;
+import java.math.BigInteger;
 import java.net.URL;
+import java.nio.ByteBuffer;
+import java.util.Collection;
+import java.util.Iterator;
+import java.util.Map;
 
 import com.fasterxml.jackson.core.FormatSchema;
 import com.fasterxml.jackson.core.JsonEncoding;
@@ -34,14 +41,21 @@ import com.fasterxml.jackson.core.JsonGenerator;
 import com.fasterxml.jackson.core.JsonParser;
 import com.fasterxml.jackson.core.PrettyPrinter;
 import com.fasterxml.jackson.databind.DeserializationConfig;
+import com.fasterxml.jackson.databind.DeserializationContext;
 import com.fasterxml.jackson.databind.InjectableValues;
 import com.fasterxml.jackson.databind.JavaType;
+import com.fasterxml.jackson.databind.JsonNode;
 import com.fasterxml.jackson.databind.JsonDeserializer;
+import com.fasterxml.jackson.databind.JsonSerializer;
+import com.fasterxml.jackson.databind.Module;
 import com.fasterxml.jackson.databind.ObjectMapper;
 import com.fasterxml.jackson.databind.ObjectReader;
 import com.fasterxml.jackson.databind.ObjectWriter;
 import com.fasterxml.jackson.databind.SerializationConfig;
+import com.fasterxml.jackson.databind.SerializerProvider;
 import com.fasterxml.jackson.databind.deser.DataFormatReaders;
+import com.fasterxml.jackson.databind.module.SimpleModule;
+import com.fasterxml.jackson.databind.node.POJONode;
 
 /**
  * Specialized {@link ObjectMapper} to use with YAJBE data format.
@@ -51,6 +65,21 @@ public class YajbeMapper extends ObjectMapper {
 
   /** Config name for the known field names */
   public static final String CONFIG_MAP_FIELD_NAMES = "map.field.names";
+  /** Config name for the {@link YajbeBlobWriter}, bytes above the threshold are moved to the sidecar region */
+  public static final String CONFIG_BLOB_WRITER = "blob.writer";
+  /** Config name for the {@link YajbeBlobReader}, to resolve the blob references */
+  public static final String CONFIG_BLOB_READER = "blob.reader";
+  /**
+   * Config name for the max buffer size (Integer) used to write the arrays and maps of unknown size with the count,
+   * instead of the EOF form. The containers still open when the buffer is full are written in the EOF form.
+   */
+  public static final String CONFIG_COUNTED_CONTAINERS = "counted.containers";
+  /**
+   * Config name for the max depth (Integer) of the arrays and maps written as sized containers (1 for the children of the root).
+   * The byte length is written in front of them, so a reader can skip them without reading the content.
+   * The buffer size of {@link #CONFIG_COUNTED_CONTAINERS} is used, if specified.
+   */
+  public static final String CONFIG_SIZED_CONTAINERS = "sized.containers";
 
   /**
    * Default constructor, which will construct the default {@link YajbeFactory}
@@ -69,6 +98,282 @@ public class YajbeMapper extends ObjectMapper {
   public YajbeMapper(final YajbeFactory factory) {
     super(factory);
     // enable(SerializationFeature.ORDER_MAP_ENTRIES_BY_KEYS);
+    registerModule(new SimpleModule("Yajbe")
+      .addDeserializer(ByteBuffer.class, new BlobByteBufferDeserializer())
+      .addDeserializer(YajbeDocument.class, new YajbeDocumentDeserializer()));
+  }
+
+  /**
+   * ByteBuffer fields of a blob reference get a read-only view of the sidecar region, without copying the bytes.
+   */
+  private static final class BlobByteBufferDeserializer extends JsonDeserializer<ByteBuffer> {
+    @Override
+    public ByteBuffer deserialize(final JsonParser p, final DeserializationContext ctxt) throws IOException {
+      if (p instanceof final YajbeParser yp && yp.isBlobRef()) {
+        return yp.blobValue();
+      }
+      return ByteBuffer.wrap(p.getBinaryValue());
+    }
+  }
+
+  /**
+   * Embedded documents are kept encoded, the value is decoded on access.
+   */
+  private static final class YajbeDocumentDeserializer extends JsonDeserializer<YajbeDocument> {
+    @Override
+    public YajbeDocument deserialize(final JsonParser p, final DeserializationContext ctxt) throws IOException {
+      if (p instanceof final YajbeParser yp && yp.isEmbeddedDocument()) {
+        return yp.embeddedDocument();
+      }
+      return YajbeDocument.wrap(p.getBinaryValue());
+    }
+  }
+
+  // ==========================================================================================
+  // Int Map Keys
+  // ==========================================================================================
+  /**
+   * Module that writes the Integer/Long/Short/Byte keys of a Map using the int heads,
+   * instead of converting them to a String field name. (e.g. Map&lt;Long, V&gt; id lookup tables)
+   * Int keys are not indexed, so this is useful when the keys are mostly unique.
+   * On decode the int keys are returned as field names in decimal form,
+   * so the standard Jackson key deserializers are able to convert them back.
+   *
+   * @return the module to register with {@link #registerModule(Module)}
+   */
+  public static Module intMapKeysModule() {
+    final IntMapKeySerializer serializer = new IntMapKeySerializer();
+    final SimpleModule module = new SimpleModule("YajbeIntMapKeys");
+    module.addKeySerializer(Integer.class, serializer);
+    module.addKeySerializer(Long.class, serializer);
+    module.addKeySerializer(Short.class, serializer);
+    module.addKeySerializer(Byte.class, serializer);
+    return module;
+  }
+
+  private static final class IntMapKeySerializer extends JsonSerializer<Number> {
+    @Override
+    public void serialize(final Number value, final JsonGenerator gen, final SerializerProvider serializers) throws IOException {
+      // non-yajbe generators fallback to writeFieldName(Long.toString(id))
+      gen.writeFieldId(value.longValue());
+    }
+  }
+
+  // ==========================================================================================
+  // Encoded Size
+  // ==========================================================================================
+  /**
+   * Computes the exact size in bytes of the encoded value, without writing the bytes.
+   * The value goes through the same encoder state (field names index, prefix/suffix, enum mapping)
+   * used by writeValueAsBytes(), so the result can be used to allocate the output buffer once
+   * or to length-prefix the message.
+   *
+   * @param value the value to encode
+   * @return the exact size of the encoded value
+   * @throws IOException if the value cannot be serialized
+   */
+  public long computeEncodedSize(final Object value) throws IOException {
+    return computeEncodedSize(writer(), value);
+  }
+
+  /**
+   * Computes the exact size in bytes of the value encoded with the specified writer (e.g. with initial field names).
+   *
+   * @param writer a writer created by this mapper
+   * @param value the value to encode
+   * @return the exact size of the encoded value
+   * @throws IOException if the value cannot be serialized
+   */
+  public long computeEncodedSize(final ObjectWriter writer, final Object value) throws IOException {
+    if (writer instanceof final YajbeWriter yajbeWriter) {
+      return yajbeWriter.computeEncodedSize(value);
+    }
+    throw new IllegalArgumentException("expected a writer created by YajbeMapper, got " + writer);
+  }
+
+  /**
+   * Cheap upper bound of the encoded size, to be used for admission control.
+   * Maps, collections, arrays, JsonNode and scalars are visited without encoding,
+   * assuming the worst case for each item (no field names index, no enum mapping, 3 bytes per char).
+   * Other objects (e.g. POJOs) fall back to {@link #computeEncodedSize(Object)}.
+   *
+   * @param value the value to encode
+   * @return an upper bound of the encoded size
+   * @throws IOException if the value cannot be serialized
+   */
+  public long estimateMaxEncodedSize(final Object value) throws IOException {
+    // the enum config header can be written once
+    return 3 + estimateMaxItemSize(value);
+  }
+
+  private static final int MAX_LENGTH_HEAD_SIZE = 5;
+  private static final int MAX_FIELD_HEAD_SIZE = 3;
+
+  private long estimateMaxItemSize(final Object value) throws IOException {
+    if (value == null || value instanceof Boolean) return 1;
+    if (value instanceof final CharSequence text) return MAX_LENGTH_HEAD_SIZE + 3L * text.length();
+    if (value instanceof final byte[] data) return MAX_LENGTH_HEAD_SIZE + data.length;
+    if (value instanceof Float) return 5;
+    if (value instanceof Number) {
+      if (value instanceof final BigInteger bigInt) return 15 + (bigInt.bitLength() >> 3);
+      if (value instanceof final BigDecimal bigDec) return 15 + (bigDec.unscaledValue().bitLength() >> 3);
+      return 9;
+    }
+    if (value instanceof final int[] array) return MAX_LENGTH_HEAD_SIZE + 5L * array.length;
+    if (value instanceof final long[] array) return MAX_LENGTH_HEAD_SIZE + 9L * array.length;
+    if (value instanceof final Map<?, ?> map) {
+      long size = MAX_LENGTH_HEAD_SIZE;
+      for (final Map.Entry<?, ?> entry: map.entrySet()) {
+        size += MAX_FIELD_HEAD_SIZE + 3L * String.valueOf(entry.getKey()).length();
+        size += estimateMaxItemSize(entry.getValue());
+      }
+      return size;
+    }
+    if (value instanceof final Collection<?> collection) {
+      long size = MAX_LENGTH_HEAD_SIZE;
+      for (final Object item: collection) {
+        size += estimateMaxItemSize(item);
+      }
+      return size;
+    }
+    if (value instanceof final Object[] array) {
+      long size = MAX_LENGTH_HEAD_SIZE;
+      for (final Object item: array) {
+        size += estimateMaxItemSize(item);
+      }
+      return size;
+    }
+    if (value instanceof final JsonNode node) {
+      return estimateMaxNodeSize(node);
+    }
+    return computeEncodedSize(value);
+  }
+
+  private long estimateMaxNodeSize(final JsonNode node) throws IOException {
+    switch (node.getNodeType()) {
+      case OBJECT: {
+        long size = MAX_LENGTH_HEAD_SIZE;
+        final Iterator<Map.Entry<String, JsonNode>> it = node.fields();
+        while (it.hasNext()) {
+          final Map.Entry<String, JsonNode> entry = it.next();
+          size += MAX_FIELD_HEAD_SIZE + 3L * entry.getKey().length();
+          size += estimateMaxNodeSize(entry.getValue());
+        }
+        return size;
+      }
+      case ARRAY: {
+        long size = MAX_LENGTH_HEAD_SIZE;
+        for (final JsonNode item: node) {
+          size += estimateMaxNodeSize(item);
+        }
+        return size;
+      }
+      case STRING: return MAX_LENGTH_HEAD_SIZE + 3L * node.textValue().length();
+      case BINARY: return MAX_LENGTH_HEAD_SIZE + node.binaryValue().length;
+      case NUMBER: return estimateMaxItemSize(node.numberValue());
+      case POJO: return estimateMaxItemSize(((POJONode) node).getPojo());
+      default: return 1;
+    }
+  }
+
+  // ==========================================================================================
+  // DOM Encoding
+  // ==========================================================================================
+  /**
+   * Encode a JsonNode or Map/Collection tree, walking it directly without going through the serializers.
+   * Since the size of each map and array is known, they are written with the number of items instead of EOF.
+   *
+   * @param dom the JsonNode or Map/Collection tree to encode
+   * @return the encoded tree
+   * @throws IOException if the tree cannot be serialized
+   */
+  public byte[] writeDomAsBytes(final Object dom) throws IOException {
+    final ByteArrayOutputStream stream = new ByteArrayOutputStream();
+    writeDom(stream, dom);
+    return stream.toByteArray();
+  }
+
+  /**
+   * Encode a JsonNode or Map/Collection tree, walking it directly without going through the serializers.
+   *
+   * @param stream the stream where the encoded tree will be written
+   * @param dom the JsonNode or Map/Collection tree to encode
+   * @throws IOException if the tree cannot be serialized or written
+   */
+  public void writeDom(final OutputStream stream, final Object dom) throws IOException {
+    writeDom(writer(), stream, dom);
+  }
+
+  /**
+   * Encode a JsonNode or Map/Collection tree with the specified writer (e.g. with a blob writer).
+   *
+   * @param writer a writer created by this mapper
+   * @param dom the JsonNode or Map/Collection tree to encode
+   * @return the encoded tree
+   * @throws IOException if the tree cannot be serialized
+   */
+  public byte[] writeDomAsBytes(final ObjectWriter writer, final Object dom) throws IOException {
+    final ByteArrayOutputStream stream = new ByteArrayOutputStream();
+    writeDom(writer, stream, dom);
+    return stream.toByteArray();
+  }
+
+  /**
+   * Encode a JsonNode or Map/Collection tree with the specified writer (e.g. with a blob writer).
+   *
+   * @param writer a writer created by this mapper
+   * @param stream the stream where the encoded tree will be written
+   * @param dom the JsonNode or Map/Collection tree to encode
+   * @throws IOException if the tree cannot be serialized or written
+   */
+  public void writeDom(final ObjectWriter writer, final OutputStream stream, final Object dom) throws IOException {
+    if (!(writer instanceof YajbeWriter)) {
+      throw new IllegalArgumentException("expected a writer created by YajbeMapper, got " + writer);
+    }
+    try (YajbeGenerator generator = (YajbeGenerator) writer.createGenerator(stream)) {
+      generator.writeDom(dom);
+    }
+  }
+
+  // ==========================================================================================
+  // Canonical Encoding
+  // ==========================================================================================
+  /**
+   * Encode the value in canonical form: map keys sorted, containers with the number of items,
+   * ints and floats at minimal width, no enum mapping.
+   * The same value always produces the same bytes, regardless of the map insertion order.
+   *
+   * @param value the value to encode
+   * @return the canonical encoding of the value
+   * @throws IOException if the value cannot be serialized
+   */
+  public byte[] writeValueAsCanonicalBytes(final Object value) throws IOException {
+    final ByteArrayOutputStream stream = new ByteArrayOutputStream();
+    YajbeCanonicalEncoder.encode(this, stream, value);
+    return stream.toByteArray();
+  }
+
+  /**
+   * Write the value in canonical form, computing the content hash while writing.
+   *
+   * @param stream the stream where the canonical encoding will be written
+   * @param value the value to encode
+   * @return the content hash of the canonical encoding
+   * @throws IOException if the value cannot be serialized or written
+   */
+  public YajbeContentHash writeCanonicalValue(final OutputStream stream, final Object value) throws IOException {
+    return YajbeCanonicalEncoder.encode(this, stream, value);
+  }
+
+  /**
+   * Compute the content hash of the canonical encoding, without keeping the encoded bytes.
+   *
+   * @param value the value to hash
+   * @return the content hash of the canonical encoding
+   * @throws IOException if the value cannot be serialized
+   */
+  public YajbeContentHash computeContentHash(final Object value) throws IOException {
+    return YajbeCanonicalEncoder.encode(this, OutputStream.nullOutputStream(), value);
   }
 
   // ==========================================================================================
@@ -155,6 +460,13 @@ public class YajbeMapper extends ObjectMapper {
       return _configureAttrs(super.createGenerator(out));
     }
 
+    long computeEncodedSize(final Object value) throws IOException {
+      try (YajbeGenerator generator = ((YajbeFactory) getFactory()).createSizeCounterGenerator()) {
+        writeValue(_configureAttrs(generator), value);
+        return generator.encodedSize();
+      }
+    }
+
     private JsonGenerator _configureAttrs(final JsonGenerator g) {
       final Object initialFields = _config.getAttributes().getAttribute(CONFIG_MAP_FIELD_NAMES);
       if (initialFields != null) {
@@ -165,6 +477,33 @@ public class YajbeMapper extends ObjectMapper {
           throw new IllegalArgumentException("expected String[] for " + CONFIG_MAP_FIELD_NAMES + ": " + initialFields);
         }
       }
+
+      final Object countedContainers = _config.getAttributes().getAttribute(CONFIG_COUNTED_CONTAINERS);
+      if (countedContainers != null) {
+        if (countedContainers instanceof final Integer maxBufferSize) {
+          ((YajbeGenerator) g).setCountedContainers(maxBufferSize);
+        } else {
+          throw new IllegalArgumentException("expected Integer for " + CONFIG_COUNTED_CONTAINERS + ": " + countedContainers);
+        }
+      }
+
+      final Object sizedContainers = _config.getAttributes().getAttribute(CONFIG_SIZED_CONTAINERS);
+      if (sizedContainers != null) {
+        if (sizedContainers instanceof final Integer maxDepth) {
+          ((YajbeGenerator) g).setSizedContainers(maxDepth);
+        } else {
+          throw new IllegalArgumentException("expected Integer for " + CONFIG_SIZED_CONTAINERS + ": " + sizedContainers);
+        }
+      }
+
+      final Object blobWriter = _config.getAttributes().getAttribute(CONFIG_BLOB_WRITER);
+      if (blobWriter != null) {
+        if (blobWriter instanceof final YajbeBlobWriter writer) {
+          ((YajbeGenerator) g).setBlobWriter(writer);
+        } else {
+          throw new IllegalArgumentException("expected YajbeBlobWriter for " + CONFIG_BLOB_WRITER + ": " + blobWriter);
+        }
+      }
       return g;
     }
   }
@@ -291,6 +630,15 @@ public class YajbeMapper extends ObjectMapper {
           throw new IllegalArgumentException("expected String[] for " + CONFIG_MAP_FIELD_NAMES + ": " + initialFields);
         }
       }
+
+      final Object blobReader = _config.getAttributes().getAttribute(CONFIG_BLOB_READER);
+      if (blobReader != null) {
+        if (blobReader instanceof final YajbeBlobReader reader) {
+          ((YajbeParser) p).setBlobReader(reader);
+        } else {
+          throw new IllegalArgumentException("expected YajbeBlobReader for " + CONFIG_BLOB_READER + ": " + blobReader);
+        }
+      }
       return p;
     }
   }
@@ -18,14 +18,18 @@
 package io.github.matteobertozzi.yajbe;
 
 import java.io.IOException;
+import java.io.OutputStream;
 import java.math.BigDecimal;
 import java.math.BigInteger;
+import java.nio.ByteBuffer;
+import java.nio.channels.Channels;
 import java.util.Arrays;
 import java.util.List;
 import java.util.Map;
 
 import com.fasterxml.jackson.core.Base64Variant;
 import com.fasterxml.jackson.core.JsonLocation;
+import com.fasterxml.jackson.core.JsonParser;
 import com.fasterxml.jackson.core.JsonStreamContext;
 import com.fasterxml.jackson.core.JsonToken;
 import com.fasterxml.jackson.core.ObjectCodec;
@@ -33,6 +37,8 @@ import com.fasterxml.jackson.core.Version;
 import com.fasterxml.jackson.core.base.ParserMinimalBase;
 import com.fasterxml.jackson.core.io.IOContext;
 
+import io.github.matteobertozzi.yajbe.YajbeReader.ByteArraySlice;
+
 /**
  * {@link ParserMinimalBase} implementation that reads YAJBE encoded content.
  */
@@ -54,6 +60,10 @@ final class YajbeParser extends ParserMinimalBase {
     fieldNameReader.setInitialFieldNames(names);
   }
 
+  void setBlobReader(final YajbeBlobReader blobReader) {
+    this.blobReader = blobReader;
+  }
+
   @Override
   public void close() {
     if (isClosed) return;
@@ -72,6 +82,7 @@ final class YajbeParser extends ParserMinimalBase {
   //   - array eof (STACK_FLAG_ARRAY | STACK_FLAG_EOF)
   //   - object fixed length (length)
   //   - object eof (STACK_FLAG_EOF)
+  //   - sized containers have the STACK_FLAG_SIZED too
   // stackState used to know if we have to call the stackStateHandler
   //   - array length = 0
   //   - array/object eof check
@@ -83,6 +94,7 @@ final class YajbeParser extends ParserMinimalBase {
 
   private static final long STACK_FLAG_ARRAY = (1L << 62);
   private static final long STACK_FLAG_EOF = (1L << 61);
+  private static final long STACK_FLAG_SIZED = (1L << 60);
   private static final long STACK_MASK_LENGTH = 0x7fffffffL;
   private static final long STACK_MASK_INFO = 0x7fffffff_00000000L;
 
@@ -109,6 +121,10 @@ final class YajbeParser extends ParserMinimalBase {
   }
 
   private void stackPop() {
+    if ((stackItem[stackSize] & STACK_FLAG_SIZED) == STACK_FLAG_SIZED) {
+      closeSized();
+    }
+
     if (stackSize-- == 0) {
       this.stackState = Long.MAX_VALUE;
       return;
@@ -140,6 +156,7 @@ final class YajbeParser extends ParserMinimalBase {
   private void startFixedObject(final int head) throws IOException {
     final int length = stream.readItemCount(head);
     stackPush(length);
+    if (sizedPending) startSized(head);
     this.stackStateHandler = this::stackFixedObjectStateHandler;
     this.stackState = 0;
     this.stackObjectAvail = length;
@@ -157,6 +174,7 @@ final class YajbeParser extends ParserMinimalBase {
 
   private void startEofObject() {
     stackPush(STACK_FLAG_EOF);
+    if (sizedPending) startSized(0b0011_1111);
     this.stackStateHandler = this::stackEofObjectStateHandler;
     this.stackState = 0;
   }
@@ -176,6 +194,7 @@ final class YajbeParser extends ParserMinimalBase {
   private void startFixedArray(final int head) throws IOException {
     final int length = stream.readItemCount(head);
     stackPush(STACK_FLAG_ARRAY | length);
+    if (sizedPending) startSized(head);
     this.stackStateHandler = this::stackFixedArrayStateHandler;
     this.stackState = length;
   }
@@ -187,6 +206,7 @@ final class YajbeParser extends ParserMinimalBase {
 
   private void startEofArray() {
     stackPush(STACK_FLAG_ARRAY | STACK_FLAG_EOF);
+    if (sizedPending) startSized(0b0010_1111);
     this.stackStateHandler = this::stackEofArrayStateHandler;
     this.stackState = 0;
   }
@@ -200,6 +220,33 @@ final class YajbeParser extends ParserMinimalBase {
     return JsonToken.END_ARRAY;
   }
 
+  // ---------------------------------------------------------------------------
+  //  Reader Stack - Sized containers
+  //  head (0x15), int byte length, array/map. the field names indexed inside are dropped
+  //  at the end of the container, so it can be skipped without reading it (see skipChildren())
+  // ---------------------------------------------------------------------------
+  private boolean sizedPending;
+  private long sizedLength;
+  // bytes left in the container just started, -1 if it is not sized or the length is not known
+  private long sizedSkipLength = -1;
+
+  private void startSized(final int head) {
+    sizedPending = false;
+    stackItem[stackSize] |= STACK_FLAG_SIZED;
+    fieldNameReader.openScope();
+    stream.openSizedScope();
+    if (sizedLength > 0) {
+      // the length includes the head and the item count
+      final int w = head & 0b1111;
+      sizedSkipLength = sizedLength - 1 - ((w > 10 && w < 15) ? (w - 10) : 0);
+    }
+  }
+
+  private void closeSized() {
+    fieldNameReader.closeScope();
+    stream.closeSizedScope();
+  }
+
   // =====================================================================================
   //  NOTE: to avoid too many ifs, we pre-build a map with the tokens.
   //  so we can find the token just by looking up TOKEN_MAP[head]
@@ -207,7 +254,8 @@ final class YajbeParser extends ParserMinimalBase {
     0, -1, 1, 2,
     12, 13, 14, 15,
     8, 9, 9,
-    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1,
+    20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
     16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 17,
     18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 19,
     3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4,
@@ -236,6 +284,12 @@ final class YajbeParser extends ParserMinimalBase {
   private static final int TOKEN_ARRAY_EOF    = 17;
   private static final int TOKEN_OBJECT       = 18;
   private static final int TOKEN_OBJECT_EOF   = 19;
+  private static final int TOKEN_CHUNKED_BYTES  = 20;
+  private static final int TOKEN_CHUNKED_STRING = 21;
+  private static final int TOKEN_BLOB_REF       = 22;
+  private static final int TOKEN_EMBEDDED_DOC   = 23;
+  private static final int TOKEN_RESET          = 24;
+  private static final int TOKEN_SIZED          = 25;
 
   private static final JsonToken[] JSON_TOKEN_MAP = new JsonToken[] {
     JsonToken.VALUE_NULL,
@@ -258,10 +312,25 @@ final class YajbeParser extends ParserMinimalBase {
     JsonToken.START_ARRAY,            // eof array
     JsonToken.START_OBJECT,           // fixed object
     JsonToken.START_OBJECT,           // eof object
+    JsonToken.VALUE_EMBEDDED_OBJECT,  // chunked bytes
+    JsonToken.VALUE_STRING,           // chunked string
+    JsonToken.VALUE_EMBEDDED_OBJECT,  // blob ref
+    JsonToken.VALUE_EMBEDDED_OBJECT,  // embedded document
+    null,                             // reset
+    null,                             // sized container (the array/map follows)
   };
 
   @Override
   public JsonToken nextToken() throws IOException {
+    blobRef = false;
+    embeddedDoc = false;
+    sizedSkipLength = -1;
+    if (chunkedHead != 0) {
+      // the chunked value was not consumed, skip it
+      chunkedHead = 0;
+      stream.transferChunks(null);
+    }
+
     if (stackState-- == 0) {
       if ((_currToken = stackStateHandler.nextToken()) != null) {
         return _currToken;
@@ -289,12 +358,68 @@ final class YajbeParser extends ParserMinimalBase {
         case TOKEN_ARRAY_EOF -> startEofArray();
         case TOKEN_OBJECT -> startFixedObject(head);
         case TOKEN_OBJECT_EOF -> startEofObject();
+        case TOKEN_CHUNKED_BYTES, TOKEN_CHUNKED_STRING -> chunkedHead = head;
+        case TOKEN_BLOB_REF -> {
+          stream.decodeBlobRef();
+          blobRef = true;
+        }
+        case TOKEN_EMBEDDED_DOC -> {
+          stream.decodeEmbeddedDocument();
+          embeddedDoc = true;
+        }
+        case TOKEN_RESET -> {
+          fieldNameReader.reset();
+          stream.resetEnumMapping();
+        }
+        case TOKEN_SIZED -> {
+          sizedLength = stream.decodeSizedLength();
+          // the sized head must be followed by an array/map
+          final int next = stream.peek();
+          if ((next & 0b1110_0000) != 0b0010_0000) {
+            throw new IOException("expected array or map after the sized head, got " + Integer.toBinaryString(next));
+          }
+          sizedPending = true;
+        }
       }
       _currToken = JSON_TOKEN_MAP[tokenId];
     } while (_currToken == null);
     return _currToken;
   }
 
+  /**
+   * The field names are read from the stream by {@link #getCurrentName()}, so the content of the container
+   * must be walked consuming them. A sized container is skipped without reading it.
+   */
+  @Override
+  public JsonParser skipChildren() throws IOException {
+    if (_currToken != JsonToken.START_OBJECT && _currToken != JsonToken.START_ARRAY) {
+      return this;
+    }
+
+    if (sizedSkipLength >= 0) {
+      stream.skipNBytes(sizedSkipLength);
+      sizedSkipLength = -1;
+      _currToken = (_currToken == JsonToken.START_ARRAY) ? JsonToken.END_ARRAY : JsonToken.END_OBJECT;
+      stackPop();
+      return this;
+    }
+
+    int level = 1;
+    while (level > 0) {
+      final JsonToken token = nextToken();
+      if (token == null) return this;
+      switch (token) {
+        case START_OBJECT, START_ARRAY -> {
+          if (sizedSkipLength >= 0) skipChildren(); else level++;
+        }
+        case END_OBJECT, END_ARRAY -> level--;
+        case FIELD_NAME -> getCurrentName();
+        default -> {}
+      }
+    }
+    return this;
+  }
+
   @Override
   protected void _handleEOF() {
     // TODO Auto-generated method stub
@@ -320,8 +445,88 @@ final class YajbeParser extends ParserMinimalBase {
     throw new UnsupportedOperationException();
   }
 
+  // ====================================================================================================
+  //  Chunked Bytes/String related
+  //  the chunks are read lazily, so readBinaryValue() can stream them without buffering the full value
+  // ====================================================================================================
+  private int chunkedHead;
+
+  private void readChunkedValue() throws IOException {
+    if (chunkedHead == 0) return;
+
+    if (chunkedHead == 0b00010001) {
+      stream.decodeChunkedString();
+    } else {
+      stream.decodeChunkedBytes();
+    }
+    chunkedHead = 0;
+  }
+
+  // ====================================================================================================
+  //  Embedded document related
+  // ====================================================================================================
+  private boolean embeddedDoc;
+
+  boolean isEmbeddedDocument() {
+    return embeddedDoc;
+  }
+
+  /**
+   * @return the embedded document, still encoded. it will be decoded on access
+   */
+  YajbeDocument embeddedDocument() {
+    return YajbeDocument.wrap(stream.bytesValue().toByteArray());
+  }
+
+  // ====================================================================================================
+  //  Blob reference related
+  // ====================================================================================================
+  private YajbeBlobReader blobReader;
+  private boolean blobRef;
+
+  boolean isBlobRef() {
+    return blobRef;
+  }
+
+  /**
+   * @return a read-only view of the blob in the sidecar region, without copying it
+   */
+  ByteBuffer blobValue() throws IOException {
+    if (blobReader == null) {
+      throw new IOException("found a blob reference, but no blob reader was configured (" + YajbeMapper.CONFIG_BLOB_READER + ")");
+    }
+    return blobReader.get(stream.blobOffset(), stream.blobLength());
+  }
+
+  private byte[] blobBytes() throws IOException {
+    final ByteBuffer blob = blobValue();
+    final byte[] data = new byte[blob.remaining()];
+    blob.get(data);
+    return data;
+  }
+
   @Override
-  public String getText() {
+  public int readBinaryValue(final Base64Variant bv, final OutputStream out) throws IOException {
+    if (blobRef) {
+      final ByteBuffer blob = blobValue();
+      final int length = blob.remaining();
+      Channels.newChannel(out).write(blob);
+      return length;
+    }
+
+    if (chunkedHead != 0) {
+      chunkedHead = 0;
+      return Math.toIntExact(stream.transferChunks(out));
+    }
+
+    final ByteArraySlice bytes = stream.bytesValue();
+    if (bytes.len() > 0) out.write(bytes.buf(), bytes.off(), bytes.len());
+    return bytes.len();
+  }
+
+  @Override
+  public String getText() throws IOException {
+    readChunkedValue();
     return stream.stringValue();
   }
 
@@ -346,12 +551,17 @@ final class YajbeParser extends ParserMinimalBase {
   }
 
   @Override
-  public byte[] getBinaryValue(final Base64Variant b64variant) {
+  public byte[] getBinaryValue(final Base64Variant b64variant) throws IOException {
+    if (blobRef) return blobBytes();
+    readChunkedValue();
     return stream.bytesValue().toByteArray();
   }
 
   @Override
-  public Object getEmbeddedObject() {
+  public Object getEmbeddedObject() throws IOException {
+    if (blobRef) return blobBytes();
+    if (embeddedDoc) return embeddedDocument();
+    readChunkedValue();
     return switch (_currToken) {
       case START_ARRAY -> List.of();
       case START_OBJECT -> Map.of();
@@ -505,7 +715,15 @@ final class YajbeParser extends ParserMinimalBase {
       } else if ((head & 0b0010_0000) == 0b0010_0000) {
         tokens[i] = TOKEN_ARRAY;
       } else if ((head & 0b0001_0000) == 0b0001_0000) {
-        tokens[i] = -1;
+        switch (head) {
+          case 0b00010000 -> tokens[i] = TOKEN_CHUNKED_BYTES;
+          case 0b00010001 -> tokens[i] = TOKEN_CHUNKED_STRING;
+          case 0b00010010 -> tokens[i] = TOKEN_BLOB_REF;
+          case 0b00010011 -> tokens[i] = TOKEN_EMBEDDED_DOC;
+          case 0b00010100 -> tokens[i] = TOKEN_RESET;
+          case 0b00010101 -> tokens[i] = TOKEN_SIZED;
+          default -> tokens[i] = -1;
+        }
       } else if ((head & 0b00001_000) == 0b00001_000) {
         switch (head) {
           case 0b00001000 -> tokens[i] = TOKEN_ENUM_CONFIG;
@@ -17,12 +17,15 @@
 
 package io.github.matteobertozzi.yajbe;
 
+import java.io.ByteArrayOutputStream;
 import java.io.IOException;
 import java.io.InputStream;
+import java.io.OutputStream;
 import java.math.BigDecimal;
 import java.math.BigInteger;
 import java.math.MathContext;
 import java.nio.charset.Charset;
+import java.nio.charset.StandardCharsets;
 
 import com.fasterxml.jackson.core.JsonParser.NumberType;
 
@@ -34,6 +37,7 @@ abstract class YajbeReader {
   protected abstract void readNBytes(final byte[] buf, final int off, final int len) throws IOException;
   protected abstract long readFixed(final int width) throws IOException;
   protected abstract int readFixedInt(final int width) throws IOException;
+  protected abstract void skipNBytes(final long n) throws IOException;
 
   // =========================================================================================================
   @SuppressWarnings("fallthrough")
@@ -100,15 +104,29 @@ abstract class YajbeReader {
   // ====================================================================================================
   //  String related
   // ====================================================================================================
+  private YajbeStringInternTable internTable;
+
+  public final void setStringInternTable(final YajbeStringInternTable internTable) {
+    this.internTable = internTable;
+  }
+
   public final void decodeSmallString(final int head) throws IOException {
-    strValue = readString(head & 0b111111);
-    if (enumMapping != null) enumMapping.add(strValue);
+    strValue = readStringValue(head & 0b111111);
+    if (enumMapping != null && sizedDepth == 0) enumMapping.add(strValue);
   }
 
   public final void decodeString(final int head) throws IOException {
     final int length = 59 + readFixedInt((head & 0b111111) - 59);
-    strValue = readString(length);
-    if (enumMapping != null) enumMapping.add(strValue);
+    strValue = readStringValue(length);
+    if (enumMapping != null && sizedDepth == 0) enumMapping.add(strValue);
+  }
+
+  private String readStringValue(final int length) throws IOException {
+    if (internTable == null || length > internTable.maxLength()) {
+      return readString(length);
+    }
+    final ByteArraySlice utf8 = readNBytes(length);
+    return internTable.intern(utf8.buf(), utf8.off(), utf8.len());
   }
 
   // ====================================================================================================
@@ -153,6 +171,113 @@ abstract class YajbeReader {
     bytesValue = readNBytes(length);
   }
 
+  // ====================================================================================================
+  //  Reset related
+  // ====================================================================================================
+  public final void resetEnumMapping() {
+    enumMapping = null;
+  }
+
+  // ====================================================================================================
+  //  Embedded document related
+  // ====================================================================================================
+  public final void decodeEmbeddedDocument() throws IOException {
+    final int head = read();
+    if ((head & 0b11_000000) != 0b10_000000) {
+      throw new IOException("expected bytes for the embedded document, got head: " + Integer.toBinaryString(head));
+    }
+
+    if ((head & 0b111111) <= 59) {
+      decodeSmallBytes(head);
+    } else {
+      decodeBytes(head);
+    }
+  }
+
+  // ====================================================================================================
+  //  Sized container related
+  //  head (0x15), int byte length, array/map: the enum mapping is not used inside the container
+  // ====================================================================================================
+  private int sizedDepth;
+
+  /** @return the byte length of the sized container, 0 if not known */
+  public final long decodeSizedLength() throws IOException {
+    return readIntItem();
+  }
+
+  public final void openSizedScope() {
+    sizedDepth++;
+  }
+
+  public final void closeSizedScope() {
+    sizedDepth--;
+  }
+
+  // ====================================================================================================
+  //  Blob reference related
+  // ====================================================================================================
+  private long blobOffset;
+  private long blobLength;
+
+  public long blobOffset() { return blobOffset; }
+  public long blobLength() { return blobLength; }
+
+  public final void decodeBlobRef() throws IOException {
+    blobOffset = readIntItem();
+    blobLength = readIntItem();
+  }
+
+  private long readIntItem() throws IOException {
+    final int head = read();
+    if ((head & 0b11_000000) != 0b01_000000) {
+      throw new IOException("expected an int, got head: " + Integer.toBinaryString(head));
+    }
+
+    final boolean signed = (head & 0b011_00000) == 0b011_00000;
+    final int w = head & 0b11111;
+    if (w < 24) return signed ? -w : (1 + w);
+
+    final long v = readFixed(w - 23);
+    return signed ? -(v + 24L) : (25L + v);
+  }
+
+  // ====================================================================================================
+  //  Chunked Bytes/String related
+  // ====================================================================================================
+  public final void decodeChunkedBytes() throws IOException {
+    final ByteArrayOutputStream buffer = new ByteArrayOutputStream();
+    transferChunks(buffer);
+    bytesValue = new ByteArraySlice(buffer.toByteArray());
+  }
+
+  public final void decodeChunkedString() throws IOException {
+    final ByteArrayOutputStream buffer = new ByteArrayOutputStream();
+    transferChunks(buffer);
+    strValue = buffer.toString(StandardCharsets.UTF_8);
+  }
+
+  /**
+   * Read the chunks of a chunked bytes/string (the head was already consumed) until the EOF.
+   * @param out the stream where the chunks are written, or null to skip them
+   * @return the total number of bytes read
+   */
+  public final long transferChunks(final OutputStream out) throws IOException {
+    long total = 0;
+    while (true) {
+      final int head = read();
+      if (head == 0b00000001) return total;
+      if ((head & 0b11_000000) != 0b10_000000) {
+        throw new IOException("unexpected chunk head: " + Integer.toBinaryString(head));
+      }
+
+      final int w = head & 0b111111;
+      final int length = (w <= 59) ? w : 59 + readFixedInt(w - 59);
+      final ByteArraySlice chunk = readNBytes(length);
+      if (out != null && length > 0) out.write(chunk.buf(), chunk.off(), chunk.len());
+      total += length;
+    }
+  }
+
   // ====================================================================================================
   //  Int related
   // ====================================================================================================
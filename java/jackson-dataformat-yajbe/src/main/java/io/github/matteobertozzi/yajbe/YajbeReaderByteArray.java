@@ -53,6 +53,11 @@ final class YajbeReaderByteArray extends YajbeReader {
     offset += len;
   }
 
+  @Override
+  protected void skipNBytes(final long n) {
+    offset += (int) n;
+  }
+
   @Override
   protected String readString(final int n) {
     final String r = new String(data, offset, n, StandardCharsets.UTF_8);
@@ -74,6 +74,11 @@ final class YajbeReaderStream extends YajbeReader {
     }
   }
 
+  @Override
+  protected void skipNBytes(final long n) throws IOException {
+    stream.skipNBytes(n);
+  }
+
   @Override
   protected long readFixed(final int width) throws IOException {
     readNBytes(buf8, 0, width);
@@ -0,0 +1,267 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.io.UncheckedIOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Path;
+import java.nio.file.StandardOpenOption;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Comparator;
+import java.util.List;
+import java.util.stream.IntStream;
+
+import com.fasterxml.jackson.core.JsonParser;
+import com.fasterxml.jackson.core.JsonToken;
+import com.fasterxml.jackson.databind.ObjectMapper;
+
+/**
+ * Secondary index of a record file written by {@link YajbeRecordWriter}:
+ * maps the value of a key path (e.g. "user.id") to the offsets of the records containing it.
+ * The index is built in parallel, the keys are extracted from the encoded records by walking the tokens
+ * (the records are not deserialized), then the entries are sorted by key and written in a format that can be
+ * memory-mapped and searched without loading it.
+ * <pre>
+ * +-------+-------------+-----------------------------+----------+
+ * | magic | entry count | entries (16 bytes each)     | key heap |
+ * +-------+-------------+-----------------------------+----------+
+ *  4 bytes  4 bytes      key offset (4), key length (4), record offset (8)
+ * </pre>
+ * All the integers are little-endian, the key offset is relative to the start of the key heap.
+ * Integer keys are stored as 0x01 + 8 bytes big-endian (sign flipped), string keys as 0x02 + utf-8 bytes,
+ * so the entries are sorted by comparing the key bytes. Records without the key path, or with a value
+ * that is not a string or an integer, are not indexed.
+ */
+public final class YajbeRecordIndex {
+  private static final int MAGIC = 0x58494a59; // YJIX
+  private static final int HEADER_SIZE = 8;
+  private static final int ENTRY_SIZE = 16;
+
+  private static final byte KEY_TYPE_INT = 1;
+  private static final byte KEY_TYPE_STRING = 2;
+
+  private final ByteBuffer index;
+  private final int entryCount;
+  private final int heapOffset;
+
+  /**
+   * @param index the index written by {@link #build(ObjectMapper, ByteBuffer, String, int, OutputStream)}
+   * @throws IOException if the index is not valid
+   */
+  public YajbeRecordIndex(final ByteBuffer index) throws IOException {
+    this.index = index.slice().order(ByteOrder.LITTLE_ENDIAN);
+    if (this.index.limit() < HEADER_SIZE || this.index.getInt(0) != MAGIC) {
+      throw new IOException("invalid record index header");
+    }
+    this.entryCount = this.index.getInt(4);
+    this.heapOffset = HEADER_SIZE + (entryCount * ENTRY_SIZE);
+    if (entryCount < 0 || heapOffset > this.index.limit()) {
+      throw new IOException("invalid record index, entry count " + entryCount + " size " + this.index.limit());
+    }
+  }
+
+  /**
+   * @param path the index file
+   * @return the index mapped in memory
+   * @throws IOException if the file cannot be mapped or it is not a valid index
+   */
+  public static YajbeRecordIndex map(final Path path) throws IOException {
+    try (FileChannel channel = FileChannel.open(path, StandardOpenOption.READ)) {
+      return new YajbeRecordIndex(channel.map(FileChannel.MapMode.READ_ONLY, 0, channel.size()));
+    }
+  }
+
+  /** @return the number of indexed records */
+  public int size() {
+    return entryCount;
+  }
+
+  /**
+   * @param key the key to lookup (a string or an integer)
+   * @return the offsets of the records with the specified key, in file order (use {@link YajbeRecordReader#readRecord(ByteBuffer, long)})
+   */
+  public long[] lookup(final Object key) {
+    final ByteBuffer searchKey = ByteBuffer.wrap(encodeKey(key));
+
+    // binary search of the first entry with key >= searchKey
+    int low = 0;
+    int high = entryCount;
+    while (low < high) {
+      final int mid = (low + high) >>> 1;
+      if (compareUnsigned(entryKey(mid), searchKey) < 0) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+
+    int end = low;
+    while (end < entryCount && compareUnsigned(entryKey(end), searchKey) == 0) {
+      end++;
+    }
+
+    final long[] offsets = new long[end - low];
+    for (int i = low; i < end; ++i) {
+      offsets[i - low] = index.getLong(HEADER_SIZE + (i * ENTRY_SIZE) + 8);
+    }
+    return offsets;
+  }
+
+  private ByteBuffer entryKey(final int entryIndex) {
+    final int entryOffset = HEADER_SIZE + (entryIndex * ENTRY_SIZE);
+    return index.slice(heapOffset + index.getInt(entryOffset), index.getInt(entryOffset + 4));
+  }
+
+  private static int compareUnsigned(final ByteBuffer a, final ByteBuffer b) {
+    final int i = a.mismatch(b);
+    if (i < 0) return 0;
+    if (i >= a.remaining() || i >= b.remaining()) return a.remaining() - b.remaining();
+    return Integer.compare(a.get(a.position() + i) & 0xff, b.get(b.position() + i) & 0xff);
+  }
+
+  // ====================================================================================================
+  //  Index builder
+  // ====================================================================================================
+  private record Entry (byte[] key, long recordOffset) {}
+
+  private static final Comparator<Entry> ENTRY_COMPARATOR = (a, b) -> {
+    final int cmp = Arrays.compareUnsigned(a.key(), b.key());
+    return (cmp != 0) ? cmp : Long.compare(a.recordOffset(), b.recordOffset());
+  };
+
+  /**
+   * Build the index of the records, the blocks of about blockSize bytes are scanned in parallel.
+   * @param mapper the mapper used to decode the records
+   * @param records the buffer containing the records (e.g. a memory-mapped file), offsets are relative to the position
+   * @param keyPath the path of the key to index, the field names separated by dots (e.g. "user.id")
+   * @param blockSize the minimum size of the blocks scanned by each task
+   * @param stream the stream where the index will be written
+   * @return the number of indexed records
+   * @throws IOException if a record is truncated or cannot be decoded
+   */
+  public static int build(final ObjectMapper mapper, final ByteBuffer records, final String keyPath,
+      final int blockSize, final OutputStream stream) throws IOException {
+    final ByteBuffer buf = records.slice().order(ByteOrder.LITTLE_ENDIAN);
+    final String[] path = keyPath.split("\\.");
+    final List<int[]> blocks = YajbeRecordReader.splitBlocks(buf, blockSize);
+
+    final Entry[] entries;
+    try {
+      entries = IntStream.range(0, blocks.size()).parallel()
+        .mapToObj(i -> scanBlock(mapper, buf, blocks.get(i), path))
+        .flatMap(List::stream)
+        .toArray(Entry[]::new);
+    } catch (final UncheckedIOException e) {
+      throw e.getCause();
+    }
+    Arrays.parallelSort(entries, ENTRY_COMPARATOR);
+
+    writeIndex(entries, stream);
+    return entries.length;
+  }
+
+  private static List<Entry> scanBlock(final ObjectMapper mapper, final ByteBuffer data, final int[] block, final String[] path) {
+    final ByteBuffer buf = data.duplicate().order(ByteOrder.LITTLE_ENDIAN);
+    final ArrayList<Entry> entries = new ArrayList<>(block[2]);
+    byte[] payload = new byte[256];
+    int offset = block[0];
+    for (int i = 0; i < block[2]; ++i) {
+      final int length = buf.getInt(offset);
+      if (length > payload.length) payload = new byte[length];
+      buf.get(offset + YajbeRecordWriter.HEADER_SIZE, payload, 0, length);
+
+      try (JsonParser parser = mapper.createParser(payload, 0, length)) {
+        final byte[] key = extractKey(parser, path);
+        if (key != null) entries.add(new Entry(key, offset));
+      } catch (final IOException e) {
+        throw new UncheckedIOException("unable to decode the record at offset " + offset, e);
+      }
+      offset += YajbeRecordWriter.HEADER_SIZE + length + YajbeRecordWriter.TRAILER_SIZE;
+    }
+    return entries;
+  }
+
+  private static byte[] extractKey(final JsonParser parser, final String[] path) throws IOException {
+    if (parser.nextToken() != JsonToken.START_OBJECT) return null;
+
+    int depth = 0;
+    while (parser.nextToken() == JsonToken.FIELD_NAME) {
+      // the field name is read from the stream, it must be consumed before the value
+      final String name = parser.getCurrentName();
+      final JsonToken value = parser.nextToken();
+      if (value == null) {
+        return null;
+      } else if (!path[depth].equals(name)) {
+        // the sized containers are skipped without reading them
+        parser.skipChildren();
+      } else if (++depth == path.length) {
+        return switch (value) {
+          case VALUE_STRING -> encodeKey(parser.getText());
+          case VALUE_NUMBER_INT -> (parser.getNumberType() != JsonParser.NumberType.BIG_INTEGER) ? encodeKey(parser.getLongValue()) : null;
+          default -> null;
+        };
+      } else if (value != JsonToken.START_OBJECT) {
+        return null;
+      }
+    }
+    return null;
+  }
+
+  static byte[] encodeKey(final Object key) {
+    if (key instanceof final String text) {
+      final byte[] utf8 = text.getBytes(StandardCharsets.UTF_8);
+      final byte[] buf = new byte[1 + utf8.length];
+      buf[0] = KEY_TYPE_STRING;
+      System.arraycopy(utf8, 0, buf, 1, utf8.length);
+      return buf;
+    }
+    if (key instanceof Long || key instanceof Integer || key instanceof Short || key instanceof Byte) {
+      final long value = ((Number) key).longValue() ^ Long.MIN_VALUE;
+      final byte[] buf = new byte[9];
+      buf[0] = KEY_TYPE_INT;
+      for (int i = 0; i < 8; ++i) {
+        buf[1 + i] = (byte) (value >>> (56 - (i << 3)));
+      }
+      return buf;
+    }
+    throw new IllegalArgumentException("unsupported key type " + (key != null ? key.getClass().getName() : null));
+  }
+
+  private static void writeIndex(final Entry[] entries, final OutputStream stream) throws IOException {
+    final ByteBuffer header = ByteBuffer.allocate(HEADER_SIZE + (entries.length * ENTRY_SIZE)).order(ByteOrder.LITTLE_ENDIAN);
+    header.putInt(MAGIC);
+    header.putInt(entries.length);
+    int keyOffset = 0;
+    for (final Entry entry: entries) {
+      header.putInt(keyOffset);
+      header.putInt(entry.key().length);
+      header.putLong(entry.recordOffset());
+      keyOffset += entry.key().length;
+    }
+    stream.write(header.array(), 0, header.position());
+    for (final Entry entry: entries) {
+      stream.write(entry.key());
+    }
+  }
+}
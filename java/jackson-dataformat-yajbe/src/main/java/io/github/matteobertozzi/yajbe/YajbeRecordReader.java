@@ -0,0 +1,201 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.Closeable;
+import java.io.EOFException;
+import java.io.IOException;
+import java.io.InputStream;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.stream.IntStream;
+import java.util.zip.CRC32C;
+
+import com.fasterxml.jackson.databind.ObjectMapper;
+
+/**
+ * Reads the records written by {@link YajbeRecordWriter}, verifying the CRC32C of each record.
+ */
+public final class YajbeRecordReader implements Closeable {
+  private final byte[] header = new byte[YajbeRecordWriter.HEADER_SIZE];
+  private final CRC32C crc = new CRC32C();
+  private final ObjectMapper mapper;
+  private final InputStream stream;
+  private long offset;
+
+  /**
+   * @param mapper the mapper used to decode the records
+   * @param stream the stream containing the records
+   */
+  public YajbeRecordReader(final ObjectMapper mapper, final InputStream stream) {
+    this.mapper = mapper;
+    this.stream = stream;
+  }
+
+  /**
+   * @return the payload of the next record, or null if there are no more records
+   * @throws IOException if the record is truncated or the checksum does not match
+   */
+  public byte[] nextRecord() throws IOException {
+    final int n = stream.readNBytes(header, 0, header.length);
+    if (n == 0) return null;
+    if (n != header.length) throw new EOFException("truncated record header at offset " + offset);
+
+    final int length = YajbeReader.readFixedInt(header, 0, 4);
+    if (length < 0) throw new IOException("invalid record length " + length + " at offset " + offset);
+
+    final byte[] payload = stream.readNBytes(length);
+    if (payload.length != length || stream.readNBytes(header, 0, 4) != 4) {
+      throw new EOFException("truncated record at offset " + offset);
+    }
+
+    crc.reset();
+    crc.update(payload, 0, length);
+    if ((int) crc.getValue() != YajbeReader.readFixedInt(header, 0, 4)) {
+      throw new IOException("record checksum mismatch at offset " + offset);
+    }
+    offset += YajbeRecordWriter.HEADER_SIZE + length + YajbeRecordWriter.TRAILER_SIZE;
+    return payload;
+  }
+
+  /**
+   * @param valueType the type of the value to decode
+   * @return the decoded value of the next record, or null if there are no more records
+   * @throws IOException if the record is corrupted or cannot be decoded
+   */
+  public <T> T nextValue(final Class<T> valueType) throws IOException {
+    final byte[] payload = nextRecord();
+    return payload != null ? mapper.readValue(payload, valueType) : null;
+  }
+
+  /**
+   * Read the record at the specified offset (e.g. found with a {@link YajbeRecordIndex}), verifying the checksum.
+   * @param data the buffer containing the records (e.g. a memory-mapped file), offsets are relative to the position
+   * @param offset the offset of the record
+   * @return the payload of the record
+   * @throws IOException if the record is truncated or the checksum does not match
+   */
+  public static byte[] readRecord(final ByteBuffer data, final long offset) throws IOException {
+    final ByteBuffer buf = data.slice().order(ByteOrder.LITTLE_ENDIAN);
+    if (offset < 0 || (buf.limit() - offset) < YajbeRecordWriter.HEADER_SIZE) {
+      throw new EOFException("truncated record header at offset " + offset);
+    }
+
+    final int recordOffset = (int) offset;
+    final int length = buf.getInt(recordOffset);
+    final long recordSize = (long) YajbeRecordWriter.HEADER_SIZE + length + YajbeRecordWriter.TRAILER_SIZE;
+    if (length < 0 || recordSize > (buf.limit() - offset)) {
+      throw new EOFException("truncated record at offset " + offset);
+    }
+
+    final byte[] payload = new byte[length];
+    buf.get(recordOffset + YajbeRecordWriter.HEADER_SIZE, payload);
+
+    final CRC32C crc = new CRC32C();
+    crc.update(payload, 0, length);
+    if ((int) crc.getValue() != buf.getInt(recordOffset + YajbeRecordWriter.HEADER_SIZE + length)) {
+      throw new IOException("record checksum mismatch at offset " + offset);
+    }
+    return payload;
+  }
+
+  @Override
+  public void close() throws IOException {
+    stream.close();
+  }
+
+  // =========================================================================================================
+  //  Parallel verification
+  // =========================================================================================================
+  /**
+   * Verify the checksum of all the records in the buffer (e.g. a memory-mapped file).
+   * The record boundaries are found with a sequential scan of the headers,
+   * then the records are grouped in blocks of about blockSize bytes that are verified in parallel.
+   *
+   * @param data the buffer containing the records (from position to limit)
+   * @param blockSize the minimum size of the blocks verified by each task
+   * @return the number of records in the buffer
+   * @throws IOException if a record is truncated or the checksum does not match
+   */
+  public static int verify(final ByteBuffer data, final int blockSize) throws IOException {
+    final ByteBuffer buf = data.slice().order(ByteOrder.LITTLE_ENDIAN);
+    final List<int[]> blocks = splitBlocks(buf, blockSize);
+
+    final int corruptedOffset = IntStream.range(0, blocks.size()).parallel()
+      .map(i -> verifyBlock(buf, blocks.get(i)))
+      .filter(blockOffset -> blockOffset >= 0)
+      .min().orElse(-1);
+    if (corruptedOffset >= 0) {
+      throw new IOException("record checksum mismatch at offset " + corruptedOffset);
+    }
+    return blocks.stream().mapToInt(block -> block[2]).sum();
+  }
+
+  /**
+   * Find the record boundaries with a sequential scan of the headers,
+   * and group the records in blocks of about blockSize bytes.
+   * @return the blocks as { start offset, end offset, record count }
+   */
+  static List<int[]> splitBlocks(final ByteBuffer buf, final int blockSize) throws IOException {
+    final List<int[]> blocks = new ArrayList<>();
+    int blockStart = 0;
+    int blockRecords = 0;
+    int offset = 0;
+    while (offset < buf.limit()) {
+      if ((buf.limit() - offset) < YajbeRecordWriter.HEADER_SIZE) {
+        throw new EOFException("truncated record header at offset " + offset);
+      }
+      final int length = buf.getInt(offset);
+      final long recordSize = (long) YajbeRecordWriter.HEADER_SIZE + length + YajbeRecordWriter.TRAILER_SIZE;
+      if (length < 0 || recordSize > (buf.limit() - offset)) {
+        throw new EOFException("truncated record at offset " + offset);
+      }
+      offset += (int) recordSize;
+      blockRecords++;
+      if ((offset - blockStart) >= blockSize) {
+        blocks.add(new int[] { blockStart, offset, blockRecords });
+        blockStart = offset;
+        blockRecords = 0;
+      }
+    }
+    if (blockRecords != 0) {
+      blocks.add(new int[] { blockStart, offset, blockRecords });
+    }
+    return blocks;
+  }
+
+  private static int verifyBlock(final ByteBuffer data, final int[] block) {
+    final ByteBuffer buf = data.duplicate().order(ByteOrder.LITTLE_ENDIAN);
+    final CRC32C crc = new CRC32C();
+    int offset = block[0];
+    for (int i = 0; i < block[2]; ++i) {
+      final int length = buf.getInt(offset);
+      final int payloadOffset = offset + YajbeRecordWriter.HEADER_SIZE;
+      crc.reset();
+      crc.update(buf.limit(payloadOffset + length).position(payloadOffset));
+      buf.limit(buf.capacity());
+      if ((int) crc.getValue() != buf.getInt(payloadOffset + length)) {
+        return offset;
+      }
+      offset = payloadOffset + length + YajbeRecordWriter.TRAILER_SIZE;
+    }
+    return -1;
+  }
+}
@@ -0,0 +1,176 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.Closeable;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.util.Arrays;
+import java.util.zip.CRC32C;
+
+import com.fasterxml.jackson.core.JsonGenerator;
+import com.fasterxml.jackson.databind.ObjectMapper;
+import com.fasterxml.jackson.databind.ObjectWriter;
+
+/**
+ * Writes a sequence of YAJBE encoded records, each one protected by a CRC32C checksum.
+ * <pre>
+ * +--------+---------+--------+
+ * | length | payload | crc32c |
+ * +--------+---------+--------+
+ *  4 bytes  length     4 bytes (little-endian)
+ * </pre>
+ * The CRC32C (hardware accelerated by the JVM) is computed on the chunks flushed by the encoder,
+ * while they are still in cache, so there is no extra pass over the record.
+ */
+public final class YajbeRecordWriter implements Closeable {
+  static final int HEADER_SIZE = 4;
+  static final int TRAILER_SIZE = 4;
+
+  private final RecordBuffer buffer = new RecordBuffer();
+  private final ObjectWriter writer;
+  private final OutputStream stream;
+  private YajbeBlockStats.Collector blockStats;
+  private long recordCount;
+  private long offset;
+
+  /**
+   * @param mapper the mapper used to encode the records
+   * @param stream the stream where the records will be written
+   */
+  public YajbeRecordWriter(final ObjectMapper mapper, final OutputStream stream) {
+    this.writer = mapper.writer().without(JsonGenerator.Feature.AUTO_CLOSE_TARGET);
+    this.stream = stream;
+  }
+
+  /**
+   * Collect the per-block statistics of the records written from now on.
+   * @param blockStats the statistics collector, call {@link YajbeBlockStats.Collector#finish()} once done
+   */
+  public void setBlockStats(final YajbeBlockStats.Collector blockStats) {
+    this.blockStats = blockStats;
+  }
+
+  /** @return the number of records written */
+  public long recordCount() {
+    return recordCount;
+  }
+
+  /**
+   * Encode the value and write it as a record
+   * @param value the value to write
+   * @throws IOException if the value cannot be serialized or written
+   */
+  public void write(final Object value) throws IOException {
+    buffer.reset();
+    boolean statsCollected = false;
+    try (JsonGenerator generator = writer.createGenerator(buffer)) {
+      if (blockStats != null && generator instanceof final YajbeGenerator yajbeGenerator) {
+        // the block stats are collected while the record is encoded
+        yajbeGenerator.setBlockStats(blockStats);
+        statsCollected = true;
+      }
+      writer.writeValue(generator, value);
+    }
+    if (blockStats != null && !statsCollected) {
+      blockStats.collect(buffer.buf, HEADER_SIZE, buffer.length - HEADER_SIZE);
+    }
+    writeRecord();
+  }
+
+  /**
+   * Write an already encoded value as a record
+   * @param buf the buffer containing the encoded value
+   * @param off the offset of the encoded value
+   * @param len the length of the encoded value
+   * @throws IOException if the record cannot be written
+   */
+  public void writeRaw(final byte[] buf, final int off, final int len) throws IOException {
+    buffer.reset();
+    buffer.write(buf, off, len);
+    if (blockStats != null) {
+      // already encoded, the block stats are collected walking the record
+      blockStats.collect(buf, off, len);
+    }
+    writeRecord();
+  }
+
+  private void writeRecord() throws IOException {
+    buffer.writeRecord(stream);
+    final long recordOffset = offset;
+    final int recordSize = buffer.length + TRAILER_SIZE;
+    offset += recordSize;
+    recordCount++;
+    if (blockStats != null) {
+      blockStats.addRecord(recordOffset, recordSize);
+    }
+  }
+
+  public void flush() throws IOException {
+    stream.flush();
+  }
+
+  @Override
+  public void close() throws IOException {
+    stream.close();
+  }
+
+  private static final class RecordBuffer extends OutputStream {
+    private final CRC32C crc = new CRC32C();
+    private byte[] buf = new byte[4096];
+    private int length;
+
+    void reset() {
+      crc.reset();
+      length = HEADER_SIZE;
+    }
+
+    @Override
+    public void write(final int b) {
+      ensureCapacity(1);
+      buf[length++] = (byte) b;
+      crc.update(b);
+    }
+
+    @Override
+    public void write(final byte[] data, final int off, final int len) {
+      ensureCapacity(len);
+      System.arraycopy(data, off, buf, length, len);
+      crc.update(buf, length, len);
+      length += len;
+    }
+
+    @Override
+    public void close() {
+      // no-op, the buffer is reused for the next record
+    }
+
+    void writeRecord(final OutputStream stream) throws IOException {
+      ensureCapacity(TRAILER_SIZE);
+      YajbeWriter.writeFixed(buf, 0, length - HEADER_SIZE, 4);
+      YajbeWriter.writeFixed(buf, length, (int) crc.getValue(), 4);
+      stream.write(buf, 0, length + TRAILER_SIZE);
+    }
+
+    private void ensureCapacity(final int size) {
+      if ((length + size) > buf.length) {
+        buf = Arrays.copyOf(buf, Math.max(buf.length * 2, length + size));
+      }
+    }
+  }
+}
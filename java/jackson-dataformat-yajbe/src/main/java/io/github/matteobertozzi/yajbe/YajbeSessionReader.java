@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.ByteArrayInputStream;
+import java.io.IOException;
+
+import com.fasterxml.jackson.core.JsonParser;
+import com.fasterxml.jackson.databind.ObjectMapper;
+import com.fasterxml.jackson.databind.ObjectReader;
+
+/**
+ * Decodes the messages encoded by a {@link YajbeSessionWriter}, in the same order they were encoded.
+ * The field names and the enum mapping are kept across the messages, so the known keys are not decoded again.
+ * <p>When a message is lost or cannot be decoded, the reader is out of sync: call {@link #resync()},
+ * ask the writer for a sync point, and the messages will be rejected until the sync point is received.
+ */
+public final class YajbeSessionReader {
+  private static final int RESET_HEAD = 0b00010100;
+
+  private final MessageInputStream stream = new MessageInputStream();
+  private final ObjectReader reader;
+
+  private JsonParser parser;
+  private long messageCount;
+
+  /**
+   * @param mapper the YAJBE mapper used to decode the messages
+   */
+  public YajbeSessionReader(final ObjectMapper mapper) {
+    this(mapper.reader());
+  }
+
+  /**
+   * @param reader the reader created by the YAJBE mapper (e.g. with initial field names)
+   */
+  public YajbeSessionReader(final ObjectReader reader) {
+    this.reader = reader;
+  }
+
+  /** @return the number of messages decoded */
+  public long messageCount() {
+    return messageCount;
+  }
+
+  /** @return true if the reader is in sync with the writer, false if it is waiting for a sync point */
+  public boolean isSynced() {
+    return parser != null;
+  }
+
+  /**
+   * Discard the session state, the next message accepted will be a sync point.
+   */
+  public void resync() {
+    this.parser = null;
+  }
+
+  /**
+   * @param message the encoded message
+   * @param valueType the type of the message
+   * @return the decoded message
+   * @throws IOException if the message cannot be decoded, or the reader is waiting for a sync point
+   */
+  public <T> T decode(final byte[] message, final Class<T> valueType) throws IOException {
+    if (parser == null) {
+      if (message.length == 0 || (message[0] & 0xff) != RESET_HEAD) {
+        throw new IOException("session out of sync, waiting for a sync point");
+      }
+      parser = reader.createParser(stream);
+    }
+
+    stream.setMessage(message);
+    try {
+      parser.nextToken();
+      final T value = reader.readValue(parser, valueType);
+      if (stream.available() != 0) {
+        throw new IOException("unexpected " + stream.available() + " bytes at the end of the message");
+      }
+      messageCount++;
+      return value;
+    } catch (final IOException | RuntimeException e) {
+      // the state is unknown, the next message must be a sync point
+      resync();
+      throw e;
+    }
+  }
+
+  private static final class MessageInputStream extends ByteArrayInputStream {
+    private static final byte[] EMPTY = new byte[0];
+
+    private MessageInputStream() {
+      super(EMPTY);
+    }
+
+    private void setMessage(final byte[] message) {
+      this.buf = message;
+      this.pos = 0;
+      this.mark = 0;
+      this.count = message.length;
+    }
+  }
+}
@@ -0,0 +1,122 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+
+import com.fasterxml.jackson.core.JsonGenerator;
+import com.fasterxml.jackson.databind.ObjectMapper;
+import com.fasterxml.jackson.databind.ObjectWriter;
+
+/**
+ * Encodes the messages of a long-lived connection (e.g. small RPC messages),
+ * the field names and the enum mapping are kept across the messages, so a key is sent only once per session.
+ * The messages must be decoded, in the same order, by a {@link YajbeSessionReader}.
+ * <p>A sync point is a message starting with the reset marker: the field names and the enum mapping
+ * go back to the initial state, and the message can be decoded without the previous ones.
+ * The first message is always a sync point, the next ones are sync points when {@link #sync()} is called
+ * or every {@code syncEveryMessages}. When the reader loses a message it asks for a resync
+ * (out of band, e.g. with a flag in the protocol), and the writer calls {@link #sync()}.
+ */
+public final class YajbeSessionWriter {
+  private final ByteArrayOutputStream buffer = new ByteArrayOutputStream(256);
+  private final ObjectWriter writer;
+  private final long syncEveryMessages;
+  private YajbeEnumAutotuner enumAutotuner;
+
+  private JsonGenerator generator;
+  private long messageCount;
+  private long lastSyncMessage;
+  private boolean syncNext;
+
+  /**
+   * @param mapper the YAJBE mapper used to encode the messages
+   * @throws IOException if the encoder cannot be created
+   */
+  public YajbeSessionWriter(final ObjectMapper mapper) throws IOException {
+    this(mapper.writer(), 0);
+  }
+
+  /**
+   * @param writer the writer created by the YAJBE mapper (e.g. with initial field names)
+   * @param syncEveryMessages write a sync point every N messages (0 to disable)
+   * @throws IOException if the encoder cannot be created
+   */
+  public YajbeSessionWriter(final ObjectWriter writer, final long syncEveryMessages) throws IOException {
+    this.writer = writer.without(JsonGenerator.Feature.AUTO_CLOSE_TARGET);
+    this.syncEveryMessages = syncEveryMessages;
+    this.generator = this.writer.createGenerator(buffer);
+    this.syncNext = true;
+  }
+
+  /**
+   * Pick the enum mapping configuration by sampling the messages encoded from now on.
+   * A change of configuration is a sync point.
+   * @param enumAutotuner the autotuner of this session
+   */
+  public void setEnumAutotuner(final YajbeEnumAutotuner enumAutotuner) {
+    this.enumAutotuner = enumAutotuner;
+  }
+
+  /** @return the number of messages encoded */
+  public long messageCount() {
+    return messageCount;
+  }
+
+  /**
+   * The next message will be a sync point.
+   */
+  public void sync() {
+    this.syncNext = true;
+  }
+
+  /**
+   * @param value the message to encode
+   * @return the encoded message
+   * @throws IOException if the value cannot be serialized
+   */
+  public byte[] encode(final Object value) throws IOException {
+    if (syncEveryMessages > 0 && (messageCount - lastSyncMessage) >= syncEveryMessages) {
+      syncNext = true;
+    }
+    if (enumAutotuner != null && enumAutotuner.observe(value)) {
+      ((YajbeGenerator) generator).setEnumConfig(enumAutotuner.config());
+      syncNext = true;
+    }
+
+    buffer.reset();
+    try {
+      if (syncNext) {
+        ((YajbeGenerator) generator).writeReset();
+        lastSyncMessage = messageCount;
+        syncNext = false;
+      }
+      writer.writeValue(generator, value);
+      generator.flush();
+    } catch (final IOException | RuntimeException e) {
+      // the value was partially encoded, start from a clean state
+      generator = writer.createGenerator(buffer);
+      if (enumAutotuner != null) ((YajbeGenerator) generator).setEnumConfig(enumAutotuner.config());
+      syncNext = true;
+      throw e;
+    }
+    messageCount++;
+    return buffer.toByteArray();
+  }
+}
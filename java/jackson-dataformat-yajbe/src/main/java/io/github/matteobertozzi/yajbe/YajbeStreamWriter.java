@@ -0,0 +1,227 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.Closeable;
+import java.io.FileOutputStream;
+import java.io.Flushable;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.util.concurrent.TimeUnit;
+
+import com.fasterxml.jackson.core.JsonGenerator;
+import com.fasterxml.jackson.databind.ObjectMapper;
+import com.fasterxml.jackson.databind.ObjectWriter;
+import com.fasterxml.jackson.databind.SerializationFeature;
+
+/**
+ * Writes a never-ending array of values (e.g. log events), using the EOF form of the array.
+ * The field names and the enum mapping are shared between the values, so the keys are written once.
+ * The array can be read back one value at a time, without waiting for the end of the array:
+ * <pre>
+ * try (JsonParser parser = mapper.createParser(stream)) {
+ *   parser.nextToken(); // START_ARRAY
+ *   while (parser.nextToken() != JsonToken.END_ARRAY) {
+ *     final Event event = parser.readValueAs(Event.class);
+ *   }
+ * }
+ * </pre>
+ * <p>The stream is flushed based on the {@link FlushPolicy}: when the pending bytes or the age of the
+ * oldest pending value reach the limits. Each flush can also be a durability point (fsync) when writing to a file.
+ * The methods are synchronized, so a timer can call {@link #flushIfExpired()} while the stream is idle.
+ */
+public final class YajbeStreamWriter implements Closeable, Flushable {
+  /**
+   * @param maxPendingBytes flush once the bytes written since the last flush reach this size
+   * @param maxPendingMillis flush once the oldest value not flushed is older than this (0 to disable)
+   * @param syncOnFlush fsync the file on each flush (only for {@link FileOutputStream})
+   * @param resetEveryValues write a reset of the field names and enum mapping every N values (0 to disable),
+   *                         to bound the memory used by the decoder and to have points where a reader can start
+   */
+  public record FlushPolicy (long maxPendingBytes, long maxPendingMillis, boolean syncOnFlush, long resetEveryValues) {
+    public static final FlushPolicy DEFAULT = new FlushPolicy(64 << 10, 1000, false, 0);
+  }
+
+  private final CountingOutputStream stream;
+  private final JsonGenerator generator;
+  private final ObjectWriter writer;
+  private final FlushPolicy policy;
+  private YajbeEnumAutotuner enumAutotuner;
+
+  private long valueCount;
+  private long flushedBytes;
+  private long oldestPendingNanos = -1;
+
+  /**
+   * @param mapper the YAJBE mapper used to encode the values
+   * @param stream the stream where the array will be written
+   * @throws IOException if the array cannot be started
+   */
+  public YajbeStreamWriter(final ObjectMapper mapper, final OutputStream stream) throws IOException {
+    this(mapper.writer(), stream, FlushPolicy.DEFAULT);
+  }
+
+  /**
+   * @param writer the writer created by the YAJBE mapper (e.g. with initial field names)
+   * @param stream the stream where the array will be written
+   * @param policy the flush policy
+   * @throws IOException if the array cannot be started
+   */
+  public YajbeStreamWriter(final ObjectWriter writer, final OutputStream stream, final FlushPolicy policy) throws IOException {
+    this.writer = writer.without(SerializationFeature.FLUSH_AFTER_WRITE_VALUE)
+      .without(JsonGenerator.Feature.AUTO_CLOSE_TARGET);
+    this.stream = new CountingOutputStream(stream);
+    this.policy = policy;
+    this.generator = this.writer.createGenerator(this.stream);
+    // the root array is never buffered by the counted/sized containers, so flush() writes the values
+    ((YajbeGenerator) this.generator).writeStartEofArray();
+  }
+
+  /**
+   * Pick the enum mapping configuration by sampling the values written from now on.
+   * @param enumAutotuner the autotuner of this stream
+   */
+  public synchronized void setEnumAutotuner(final YajbeEnumAutotuner enumAutotuner) {
+    this.enumAutotuner = enumAutotuner;
+  }
+
+  /** @return the number of values written */
+  public synchronized long valueCount() {
+    return valueCount;
+  }
+
+  /** @return the number of bytes written to the stream (the bytes still buffered by the encoder are not included) */
+  public synchronized long writtenBytes() {
+    return stream.count;
+  }
+
+  /**
+   * Encode the value and append it to the array.
+   * The stream is flushed if the policy limits are reached.
+   * @param value the value to write
+   * @throws IOException if the value cannot be serialized or written
+   */
+  public synchronized void write(final Object value) throws IOException {
+    final boolean enumConfigChanged = enumAutotuner != null && enumAutotuner.observe(value);
+    if (enumConfigChanged) {
+      ((YajbeGenerator) generator).setEnumConfig(enumAutotuner.config());
+    }
+    if (enumConfigChanged || (policy.resetEveryValues() > 0 && valueCount > 0 && (valueCount % policy.resetEveryValues()) == 0)) {
+      ((YajbeGenerator) generator).writeReset();
+    }
+
+    writer.writeValue(generator, value);
+    valueCount++;
+
+    if (oldestPendingNanos < 0) oldestPendingNanos = System.nanoTime();
+    // the pending bytes are the ones already written to the stream and the ones still in the generator buffer
+    final long pendingBytes = stream.count - flushedBytes + ((YajbeGenerator) generator).bufferedSize();
+    if (pendingBytes >= policy.maxPendingBytes() || isExpired()) {
+      flush();
+    }
+  }
+
+  /**
+   * Flush the pending values if the oldest one is older than the policy max pending time.
+   * To be called periodically (e.g. by a timer) when the values are not written at a constant rate.
+   * @throws IOException if the stream cannot be flushed
+   */
+  public synchronized void flushIfExpired() throws IOException {
+    if (oldestPendingNanos >= 0 && isExpired()) {
+      flush();
+    }
+  }
+
+  private boolean isExpired() {
+    return policy.maxPendingMillis() > 0
+      && (System.nanoTime() - oldestPendingNanos) >= TimeUnit.MILLISECONDS.toNanos(policy.maxPendingMillis());
+  }
+
+  /**
+   * Flush the values written, and fsync the file if the policy requires it.
+   * @throws IOException if the stream cannot be flushed
+   */
+  @Override
+  public synchronized void flush() throws IOException {
+    generator.flush();
+    if (policy.syncOnFlush()) syncStream();
+    flushedBytes = stream.count;
+    oldestPendingNanos = -1;
+  }
+
+  /**
+   * Flush the values written and fsync the file, regardless of the policy.
+   * Once this method returns the values written are durable (only for {@link FileOutputStream}).
+   * @throws IOException if the stream cannot be flushed or synced
+   */
+  public synchronized void sync() throws IOException {
+    generator.flush();
+    syncStream();
+    flushedBytes = stream.count;
+    oldestPendingNanos = -1;
+  }
+
+  private void syncStream() throws IOException {
+    if (stream.out instanceof final FileOutputStream fileStream) {
+      fileStream.getFD().sync();
+    }
+  }
+
+  /**
+   * Close the array, flush and close the stream.
+   * @throws IOException if the stream cannot be written or closed
+   */
+  @Override
+  public synchronized void close() throws IOException {
+    generator.writeEndArray();
+    flush();
+    generator.close();
+    stream.close();
+  }
+
+  private static final class CountingOutputStream extends OutputStream {
+    private final OutputStream out;
+    private long count;
+
+    private CountingOutputStream(final OutputStream out) {
+      this.out = out;
+    }
+
+    @Override
+    public void write(final int b) throws IOException {
+      out.write(b);
+      count++;
+    }
+
+    @Override
+    public void write(final byte[] buf, final int off, final int len) throws IOException {
+      out.write(buf, off, len);
+      count += len;
+    }
+
+    @Override
+    public void flush() throws IOException {
+      out.flush();
+    }
+
+    @Override
+    public void close() throws IOException {
+      out.close();
+    }
+  }
+}
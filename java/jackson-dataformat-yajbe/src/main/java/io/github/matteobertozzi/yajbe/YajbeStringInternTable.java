@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+
+/**
+ * Bounded table used by the parser to share the decoded strings.
+ * When the same utf-8 bytes are decoded again, the String instance already in the table is returned.
+ * <p>
+ * The table is set-associative (4 ways per set) keyed by the hash of the utf-8 bytes.
+ * When a set is full, the entry with the lowest hit count is evicted.
+ * The key bytes and the string of an entry are immutable, so the table can be shared between parsers on different
+ * threads without locking: a lookup never returns a wrong string, concurrent updates may only lose an insertion.
+ * The hit counters are updated without synchronization, they are best-effort stats used only to pick the entry to evict.
+ */
+public final class YajbeStringInternTable {
+  private static final int WAYS = 4;
+
+  private final Entry[] entries;
+  private final int maxLength;
+  private final int setMask;
+
+  /**
+   * Creates an intern table
+   * @param capacity the max number of strings kept in the table (rounded to the next power of 2)
+   * @param maxLength strings with an utf-8 length larger than this value are not interned
+   */
+  public YajbeStringInternTable(final int capacity, final int maxLength) {
+    final int sets = Math.max(1, tableSizeFor(capacity) / WAYS);
+    this.entries = new Entry[sets * WAYS];
+    this.setMask = sets - 1;
+    this.maxLength = maxLength;
+  }
+
+  /** @return the max number of strings kept in the table */
+  public int capacity() {
+    return entries.length;
+  }
+
+  /** @return the max utf-8 length of the strings that will be interned */
+  public int maxLength() {
+    return maxLength;
+  }
+
+  /**
+   * @param utf8 the buffer containing the utf-8 encoded string
+   * @param off the offset of the string in the buffer
+   * @param len the length of the utf-8 encoded string
+   * @return the shared instance of the decoded string
+   */
+  public String intern(final byte[] utf8, final int off, final int len) {
+    if (len > maxLength) return new String(utf8, off, len, StandardCharsets.UTF_8);
+
+    final int hash = hash(utf8, off, len);
+    final int setOffset = (hash & setMask) * WAYS;
+    int victim = setOffset;
+    int victimHits = Integer.MAX_VALUE;
+    for (int i = 0; i < WAYS; ++i) {
+      final Entry entry = entries[setOffset + i];
+      if (entry == null) {
+        if (victimHits > 0) {
+          victim = setOffset + i;
+          victimHits = 0;
+        }
+        continue;
+      }
+
+      if (entry.match(hash, utf8, off, len)) {
+        if (entry.hits < Integer.MAX_VALUE) entry.hits++;
+        return entry.value;
+      }
+
+      // age the entries on misses, so the old hot strings can be evicted
+      final int hits = entry.hits >>> 1;
+      entry.hits = hits;
+      if (hits < victimHits) {
+        victim = setOffset + i;
+        victimHits = hits;
+      }
+    }
+
+    final byte[] key = Arrays.copyOfRange(utf8, off, off + len);
+    final String value = new String(key, StandardCharsets.UTF_8);
+    entries[victim] = new Entry(hash, key, value);
+    return value;
+  }
+
+  /**
+   * Remove all the strings from the table
+   */
+  public void clear() {
+    Arrays.fill(entries, null);
+  }
+
+  private static int hash(final byte[] buf, final int off, final int len) {
+    int h = len;
+    for (int i = 0; i < len; ++i) {
+      h = 31 * h + buf[off + i];
+    }
+    return h ^ (h >>> 16);
+  }
+
+  private static int tableSizeFor(final int capacity) {
+    return 1 << (32 - Integer.numberOfLeadingZeros(Math.max(WAYS, capacity) - 1));
+  }
+
+  private static final class Entry {
+    private final byte[] utf8;
+    private final String value;
+    private final int hash;
+    private int hits;
+
+    private Entry(final int hash, final byte[] utf8, final String value) {
+      this.hash = hash;
+      this.utf8 = utf8;
+      this.value = value;
+    }
+
+    private boolean match(final int hash, final byte[] buf, final int off, final int len) {
+      return this.hash == hash && Arrays.equals(utf8, 0, utf8.length, buf, off, off + len);
+    }
+  }
+}
@@ -0,0 +1,156 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.InterruptedIOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.ClosedChannelException;
+import java.nio.channels.FileChannel;
+import java.nio.file.ClosedWatchServiceException;
+import java.nio.file.Path;
+import java.nio.file.StandardOpenOption;
+import java.nio.file.StandardWatchEventKinds;
+import java.nio.file.WatchKey;
+import java.nio.file.WatchService;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Follows a file that is being written (like {@code tail -f}): when the end of the file is reached
+ * the read waits for the writer to append more data, instead of returning EOF.
+ * The wake up is based on the file system {@link WatchService} (inotify on Linux), with a periodic poll as fallback.
+ * <p>The stream can be used with the decoders as a regular stream: a partially written value (or record)
+ * is completed when the rest of the bytes land, and the decoder state (e.g. the field names
+ * of a {@link YajbeStreamWriter} array) is carried across the appends since the file is never re-read.
+ * <pre>
+ * try (YajbeTailInputStream tail = new YajbeTailInputStream(path);
+ *      JsonParser parser = mapper.createParser(tail)) {
+ *   parser.nextToken(); // START_ARRAY
+ *   while (parser.nextToken() != JsonToken.END_ARRAY) {
+ *     final Event event = parser.readValueAs(Event.class);
+ *   }
+ * }
+ * </pre>
+ * {@link #close()} can be called from another thread to stop following the file, the pending read returns EOF.
+ */
+public final class YajbeTailInputStream extends InputStream {
+  private static final long DEFAULT_POLL_MILLIS = 1000;
+
+  private final WatchService watcher;
+  private final byte[] oneByte = new byte[1];
+  private final FileChannel channel;
+  private final long pollMillis;
+  private volatile boolean closed;
+
+  /**
+   * @param path the file to follow, from the beginning
+   * @throws IOException if the file cannot be opened
+   */
+  public YajbeTailInputStream(final Path path) throws IOException {
+    this(path, 0, DEFAULT_POLL_MILLIS);
+  }
+
+  /**
+   * @param path the file to follow
+   * @param offset the offset where to start reading (e.g. the position of the last read)
+   * @param pollMillis the max time to wait for a notification before checking the file size again
+   * @throws IOException if the file cannot be opened or watched
+   */
+  public YajbeTailInputStream(final Path path, final long offset, final long pollMillis) throws IOException {
+    final Path absPath = path.toAbsolutePath();
+    this.channel = FileChannel.open(absPath, StandardOpenOption.READ);
+    this.channel.position(offset);
+    this.pollMillis = pollMillis;
+    this.watcher = absPath.getFileSystem().newWatchService();
+    try {
+      absPath.getParent().register(watcher, StandardWatchEventKinds.ENTRY_MODIFY);
+    } catch (final IOException | RuntimeException e) {
+      watcher.close();
+      channel.close();
+      throw e;
+    }
+  }
+
+  /**
+   * @return the offset of the next byte to read, to resume from it later
+   * @throws IOException if the position cannot be read
+   */
+  public long position() throws IOException {
+    return channel.position();
+  }
+
+  @Override
+  public int read() throws IOException {
+    return read(oneByte, 0, 1) < 0 ? -1 : (oneByte[0] & 0xff);
+  }
+
+  @Override
+  public int read(final byte[] buf, final int off, final int len) throws IOException {
+    if (len == 0) return 0;
+
+    final ByteBuffer buffer = ByteBuffer.wrap(buf, off, len);
+    while (!closed) {
+      final int n;
+      try {
+        n = channel.read(buffer);
+      } catch (final ClosedChannelException e) {
+        if (closed) return -1;
+        throw e;
+      }
+      if (n > 0) return n;
+
+      if (channel.size() < channel.position()) {
+        throw new IOException("the file was truncated, size " + channel.size() + " position " + channel.position());
+      }
+      awaitAppend();
+    }
+    return -1;
+  }
+
+  @Override
+  public int available() throws IOException {
+    return closed ? 0 : (int) Math.min(Integer.MAX_VALUE, Math.max(0, channel.size() - channel.position()));
+  }
+
+  private void awaitAppend() throws IOException {
+    try {
+      final WatchKey key = watcher.poll(pollMillis, TimeUnit.MILLISECONDS);
+      if (key == null) return;
+
+      // the events are for the whole directory (or an overflow), the caller just tries to read again
+      key.pollEvents();
+      key.reset();
+    } catch (final ClosedWatchServiceException e) {
+      // closed while waiting, the next read will return EOF
+    } catch (final InterruptedException e) {
+      Thread.currentThread().interrupt();
+      throw new InterruptedIOException("interrupted while waiting for data");
+    }
+  }
+
+  @Override
+  public void close() throws IOException {
+    closed = true;
+    try {
+      watcher.close();
+    } finally {
+      channel.close();
+    }
+  }
+}
@@ -33,6 +33,10 @@ abstract class YajbeWriter {
   }
 
   protected abstract void flush() throws IOException;
+  /** write the buffered data to the underlying stream, without flushing it */
+  protected void flushBuffer() throws IOException {}
+  /** @return the number of bytes buffered and not yet written to the underlying stream */
+  protected int bufferedSize() { return 0; }
   protected abstract void write(int v) throws IOException;
   protected abstract void write(byte[] buf, int off, int len) throws IOException;
 
@@ -44,6 +48,10 @@ abstract class YajbeWriter {
     return new YajbeWriterStream(stream, buffer);
   }
 
+  public static YajbeWriterCounter forSizeCounter() {
+    return new YajbeWriterCounter();
+  }
+
   // =========================================================================================================
   @SuppressWarnings("fallthrough")
   public static void writeFixed(final byte[] buf, final int off, final long v, final int width) {
@@ -160,7 +168,7 @@ abstract class YajbeWriter {
     writeFixed(buf, bufOff + 1, v, w);
   }
 
-  private static int writeRawInt(final byte[] buf, final int off, long v) {
+  static int writeRawInt(final byte[] buf, final int off, long v) {
     final long inlineValue;
     final int head;
     if (v > 0) {
@@ -209,6 +217,59 @@ abstract class YajbeWriter {
     write(buf, off, len);
   }
 
+  public final void writeBytesHead(final int len) throws IOException {
+    writeLength(0b10_000000, 59, len);
+  }
+
+  // ====================================================================================================
+  //  Reset related
+  //  head (0x14) between two items: the field names and the enum mapping go back to the initial state
+  // ====================================================================================================
+  public final void writeReset() throws IOException {
+    write(0b00010100);
+    enumMapping = null;
+  }
+
+  // ====================================================================================================
+  //  Embedded document related
+  //  an independently encoded document: head (0x13), bytes
+  // ====================================================================================================
+  public final void writeEmbeddedDocument(final byte[] buf, final int off, final int len) throws IOException {
+    write(0b00010011);
+    writeBytes(buf, off, len);
+  }
+
+  // ====================================================================================================
+  //  Blob reference related
+  //  the bytes are stored in the sidecar region: head (0x12), int offset, int length
+  // ====================================================================================================
+  public final void writeBlobRef(final long offset, final long length) throws IOException {
+    write(0b00010010);
+    writeInt(offset);
+    writeInt(length);
+  }
+
+  // ====================================================================================================
+  //  Chunked Bytes/String related
+  //  the length is not known: head (0x10 bytes, 0x11 utf-8 string), bytes chunks..., EOF
+  // ====================================================================================================
+  public final void writeChunkedBytesStart() throws IOException {
+    write(0b00010000);
+  }
+
+  public final void writeChunkedStringStart() throws IOException {
+    write(0b00010001);
+  }
+
+  public final void writeChunk(final byte[] buf, final int off, final int len) throws IOException {
+    // an empty chunk is not needed, the EOF is the only terminator
+    if (len > 0) writeBytes(buf, off, len);
+  }
+
+  public final void writeChunkedEnd() throws IOException {
+    writeEof();
+  }
+
   // ====================================================================================================
   //  String related
   // ====================================================================================================
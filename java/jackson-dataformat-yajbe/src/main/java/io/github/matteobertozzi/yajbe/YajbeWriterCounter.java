@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+/**
+ * Writer that does not write anything, but keeps track of how many bytes would have been written.
+ * The encoder state (field names, enum mapping) is updated as usual, so the size is exact.
+ */
+final class YajbeWriterCounter extends YajbeWriter {
+  // large enough for the biggest item written with rawBufferOffset() or rawBufferWriteBatch()
+  private final byte[] scratch = new byte[32];
+  private long size;
+
+  public long size() {
+    return size;
+  }
+
+  void addSize(final long delta) {
+    size += delta;
+  }
+
+  @Override
+  public void flush() {
+    // no-op
+  }
+
+  @Override
+  protected void write(final int v) {
+    size++;
+  }
+
+  @Override
+  protected void write(final byte[] buf, final int off, final int len) {
+    size += len;
+  }
+
+  @Override
+  protected byte[] rawBuffer() {
+    return scratch;
+  }
+
+  @Override
+  protected int rawBufferOffset(final int size) {
+    this.size += size;
+    return 0;
+  }
+
+  @Override
+  protected void rawBufferWriteBatch(final int itemCount, final int maxItemSize, final RawBufferWriter writer) {
+    for (int i = 0; i < itemCount; ++i) {
+      size += writer.writeItem(scratch, 0, i);
+    }
+  }
+}
@@ -21,7 +21,7 @@ import java.io.IOException;
 import java.io.OutputStream;
 
 final class YajbeWriterStream extends YajbeWriter {
-  private final OutputStream stream;
+  private OutputStream stream;
   private final byte[] wbuf;
   private int wbufOff;
 
@@ -31,12 +31,30 @@ final class YajbeWriterStream extends YajbeWriter {
     this.wbufOff = 0;
   }
 
+  OutputStream outputStream() {
+    return stream;
+  }
+
+  void setOutputStream(final OutputStream stream) {
+    this.stream = stream;
+  }
+
   @Override
   public void flush() throws IOException {
     rawBufferFlush();
     stream.flush();
   }
 
+  @Override
+  protected void flushBuffer() throws IOException {
+    rawBufferFlush();
+  }
+
+  @Override
+  protected int bufferedSize() {
+    return wbufOff;
+  }
+
   @Override
   protected void write(final int v) throws IOException {
     if (wbufOff == wbuf.length) {
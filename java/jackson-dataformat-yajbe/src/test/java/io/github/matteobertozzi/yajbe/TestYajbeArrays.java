@@ -26,12 +26,17 @@ import java.math.BigInteger;
 import java.util.ArrayList;
 import java.util.HashSet;
 import java.util.HexFormat;
+import java.util.LinkedHashMap;
 import java.util.List;
+import java.util.Map;
 import java.util.Set;
 
 import org.junit.jupiter.api.Assertions;
 import org.junit.jupiter.api.Test;
 
+import com.fasterxml.jackson.databind.ObjectWriter;
+import com.fasterxml.jackson.databind.cfg.ContextAttributes;
+
 public class TestYajbeArrays extends BaseYajbeTest {
   record DataObject (boolean boolValue, int intValue, long longValue, float floatValue, double doubleValue,
     BigInteger bigInt, BigDecimal bigDecimal, String strValue) {}
@@ -137,4 +142,37 @@ public class TestYajbeArrays extends BaseYajbeTest {
   public void assertArrayDecode(final String expectedEnc, final int[] input) throws IOException {
     assertArrayEquals(input, YAJBE_MAPPER.readValue(HexFormat.of().parseHex(expectedEnc), int[].class));
   }
+
+  @Test
+  public void testCountedContainers() throws IOException {
+    final ObjectWriter writer = YAJBE_MAPPER.writer(ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_COUNTED_CONTAINERS, 1 << 20));
+    // maps and iterators are written by jackson without the size
+    assertEquals("3f81614001", HexFormat.of().formatHex(YAJBE_MAPPER.writeValueAsBytes(Map.of("a", 1))));
+    assertEquals("31816140", HexFormat.of().formatHex(writer.writeValueAsBytes(Map.of("a", 1))));
+    assertEquals("23404142", HexFormat.of().formatHex(writer.writeValueAsBytes(List.of(1, 2, 3).iterator())));
+    assertEquals("31816d31817840", HexFormat.of().formatHex(writer.writeValueAsBytes(Map.of("m", Map.of("x", 1)))));
+    assertEquals("318161" + "2b01" + "60".repeat(11), HexFormat.of().formatHex(writer.writeValueAsBytes(Map.of("a", new ArrayList<>(List.of(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)).iterator()))));
+
+    final LinkedHashMap<String, Object> large = new LinkedHashMap<>();
+    for (int i = 0; i < 20; ++i) {
+      large.put("k" + i, Map.of("v", List.of(i).iterator()));
+    }
+    final byte[] enc = writer.writeValueAsBytes(large);
+    assertEquals("3b0a", HexFormat.of().formatHex(enc, 0, 2));
+    assertEquals(enc.length, YAJBE_MAPPER.computeEncodedSize(writer, large));
+
+    final LinkedHashMap<String, Object> expected = new LinkedHashMap<>();
+    for (int i = 0; i < 20; ++i) {
+      expected.put("k" + i, Map.of("v", List.of(i)));
+    }
+    assertEquals(expected, YAJBE_MAPPER.readValue(enc, Map.class));
+
+    // the buffer is full, the containers still open are written in the EOF form
+    final ObjectWriter smallWriter = YAJBE_MAPPER.writer(ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_COUNTED_CONTAINERS, 16));
+    final byte[] eofEnc = smallWriter.writeValueAsBytes(large);
+    assertEquals("3f", HexFormat.of().formatHex(eofEnc, 0, 1));
+    assertEquals(expected, YAJBE_MAPPER.readValue(eofEnc, Map.class));
+  }
 }
@@ -0,0 +1,143 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import static org.junit.jupiter.api.Assertions.assertArrayEquals;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertThrows;
+import static org.junit.jupiter.api.Assertions.assertTrue;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.util.Arrays;
+import java.util.HexFormat;
+import java.util.Map;
+
+import org.junit.jupiter.api.Test;
+
+import com.fasterxml.jackson.databind.ObjectWriter;
+import com.fasterxml.jackson.databind.cfg.ContextAttributes;
+
+public class TestYajbeBlobs extends BaseYajbeTest {
+  record Attachment (String name, byte[] thumb, byte[] data) {}
+  record AttachmentView (String name, byte[] thumb, ByteBuffer data) {}
+
+  @Test
+  public void testSidecarStream() throws IOException {
+    final ByteArrayOutputStream sidecar = new ByteArrayOutputStream();
+    final YajbeBlobWriter blobWriter = new YajbeBlobWriter(sidecar, 64);
+    final ObjectWriter writer = YAJBE_MAPPER.writer(ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_BLOB_WRITER, blobWriter));
+
+    final byte[] data = new byte[100];
+    Arrays.fill(data, (byte) 7);
+    final byte[] enc = writer.writeValueAsBytes(Map.of("a", data));
+    assertEquals("3f816112" + "60" + "584b" + "01", HexFormat.of().formatHex(enc));
+    assertArrayEquals(data, sidecar.toByteArray());
+
+    // small values stay inline, the second blob offset is after the first one
+    final Attachment attachment = new Attachment("foo", new byte[] { 1, 2, 3 }, randBytes(1000));
+    final byte[] encAttachment = writer.writeValueAsBytes(attachment);
+    assertEquals(1100, blobWriter.size());
+    assertEquals(1100, sidecar.size());
+
+    // the size counter does not write the blobs
+    assertEquals(encAttachment.length, ((YajbeMapper) YAJBE_MAPPER).computeEncodedSize(writer, attachment));
+    assertEquals(1100, sidecar.size());
+
+    final ContextAttributes readAttrs = ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_BLOB_READER, new YajbeBlobReader(ByteBuffer.wrap(sidecar.toByteArray())));
+    final Map<?, ?> dec = YAJBE_MAPPER.reader(readAttrs).readValue(enc, Map.class);
+    assertArrayEquals(data, (byte[]) dec.get("a"));
+
+    final Attachment decAttachment = YAJBE_MAPPER.reader(readAttrs).readValue(encAttachment, Attachment.class);
+    assertEquals("foo", decAttachment.name());
+    assertArrayEquals(attachment.thumb(), decAttachment.thumb());
+    assertArrayEquals(attachment.data(), decAttachment.data());
+
+    // ByteBuffer fields are a view of the region
+    final AttachmentView view = YAJBE_MAPPER.reader(readAttrs).readValue(encAttachment, AttachmentView.class);
+    assertTrue(view.data().isReadOnly());
+    assertEquals(ByteBuffer.wrap(attachment.data()), view.data());
+
+    // a blob reference without a blob reader
+    assertThrows(IOException.class, () -> YAJBE_MAPPER.readValue(enc, Map.class));
+  }
+
+  @Test
+  public void testSameFile() throws IOException {
+    final YajbeBlobWriter blobWriter = new YajbeBlobWriter(128);
+    final ObjectWriter writer = YAJBE_MAPPER.writer(ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_BLOB_WRITER, blobWriter));
+
+    final Attachment attachment = new Attachment("bar", randBytes(200), randBytes(5000));
+    final ByteArrayOutputStream file = new ByteArrayOutputStream();
+    writer.writeValue(file, attachment);
+    final int docLength = file.size();
+    assertTrue(docLength < 64);
+    blobWriter.writeTo(file);
+    assertEquals(docLength + 5200, file.size());
+
+    final Path path = Files.createTempFile("yajbe-blobs", ".bin");
+    try {
+      Files.write(path, file.toByteArray());
+
+      final ContextAttributes readAttrs = ContextAttributes.getEmpty()
+        .withSharedAttribute(YajbeMapper.CONFIG_BLOB_READER, YajbeBlobReader.map(path, docLength));
+      final Attachment dec = YAJBE_MAPPER.reader(readAttrs).readValue(file.toByteArray(), 0, docLength, Attachment.class);
+      assertEquals("bar", dec.name());
+      assertArrayEquals(attachment.thumb(), dec.thumb());
+      assertArrayEquals(attachment.data(), dec.data());
+    } finally {
+      Files.delete(path);
+    }
+  }
+
+  @Test
+  public void testStreamedBinary() throws IOException {
+    // direct ByteBuffers are written by jackson from an InputStream, they go to the blob region too
+    final byte[] data = randBytes(100);
+    final Map<String, Object> input = Map.of("a", ByteBuffer.allocateDirect(data.length).put(data).flip());
+
+    final ByteArrayOutputStream sidecar = new ByteArrayOutputStream();
+    final ObjectWriter writer = YAJBE_MAPPER.writer(ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_BLOB_WRITER, new YajbeBlobWriter(sidecar, 64)));
+    final byte[] enc = writer.writeValueAsBytes(input);
+    assertEquals("3f816112" + "60" + "584b" + "01", HexFormat.of().formatHex(enc));
+    assertArrayEquals(data, sidecar.toByteArray());
+
+    // deferred, the stream content is buffered until writeTo()
+    final YajbeBlobWriter deferred = new YajbeBlobWriter(64);
+    final ObjectWriter deferredWriter = YAJBE_MAPPER.writer(ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_BLOB_WRITER, deferred));
+    final Map<String, Object> inputCopy = Map.of("a", ByteBuffer.allocateDirect(data.length).put(data).flip());
+    assertArrayEquals(enc, deferredWriter.writeValueAsBytes(inputCopy));
+    final ByteArrayOutputStream region = new ByteArrayOutputStream();
+    deferred.writeTo(region);
+    assertArrayEquals(data, region.toByteArray());
+  }
+
+  private byte[] randBytes(final int length) {
+    final byte[] data = new byte[length];
+    RANDOM.nextBytes(data);
+    return data;
+  }
+}
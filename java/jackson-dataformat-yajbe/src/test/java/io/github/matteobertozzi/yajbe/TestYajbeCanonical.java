@@ -0,0 +1,113 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import static org.junit.jupiter.api.Assertions.assertArrayEquals;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.nio.charset.StandardCharsets;
+import java.util.HexFormat;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+
+import org.junit.jupiter.api.Test;
+
+public class TestYajbeCanonical extends BaseYajbeTest {
+  private YajbeMapper mapper() {
+    return (YajbeMapper) YAJBE_MAPPER;
+  }
+
+  private void assertCanonical(final Object input, final String expectedHex) throws IOException {
+    final byte[] enc = mapper().writeValueAsCanonicalBytes(input);
+    assertEquals(expectedHex, HexFormat.of().formatHex(enc));
+  }
+
+  @Test
+  public void testSimple() throws IOException {
+    assertCanonical(null, "00");
+    assertCanonical(1, "40");
+    assertCanonical(3.0, "0500004040");
+    assertCanonical(3.0f, "0500004040");
+    assertCanonical(0.1, "069a9999999999b93f");
+    assertCanonical(List.of(1, 2, 3), "23404142");
+    assertCanonical(Map.of(), "30");
+
+    final LinkedHashMap<String, Object> ba = new LinkedHashMap<>();
+    ba.put("b", 1);
+    ba.put("a", 2);
+    final LinkedHashMap<String, Object> ab = new LinkedHashMap<>();
+    ab.put("a", 2);
+    ab.put("b", 1);
+    assertCanonical(ba, "32816141816240");
+    assertCanonical(ab, "32816141816240");
+    assertEquals("8dd76e809d06d4625590f047d6cffea7", mapper().computeContentHash(ba).toHexString());
+    assertEquals(mapper().computeContentHash(ab), mapper().computeContentHash(ba));
+
+    // utf-8 unsigned order: "z" (0x7a) before "é" (0xc3 0xa9)
+    final LinkedHashMap<String, Object> utf8 = new LinkedHashMap<>();
+    utf8.put("é", 1);
+    utf8.put("z", 2);
+    assertCanonical(utf8, "32817a4182c3a940");
+  }
+
+  @Test
+  public void testDecode() throws IOException {
+    final Map<String, Object> input = new LinkedHashMap<>();
+    for (int i = 0; i < 100; ++i) {
+      input.put(generateFieldName(1, 20), List.of(i, "v" + i, Map.of("x", i)));
+    }
+    final byte[] enc = mapper().writeValueAsCanonicalBytes(input);
+    assertEquals(input, YAJBE_MAPPER.readValue(enc, Map.class));
+
+    final ByteArrayOutputStream stream = new ByteArrayOutputStream();
+    final YajbeContentHash hash = mapper().writeCanonicalValue(stream, input);
+    assertArrayEquals(enc, stream.toByteArray());
+    assertEquals(hash, mapper().computeContentHash(YAJBE_MAPPER.valueToTree(input)));
+  }
+
+  @Test
+  public void testHashVectors() throws IOException {
+    assertHash("", "00000000000000000000000000000000");
+    assertHash("hello", "029bbd41b3a7d8cb191dae486a901e5b");
+    assertHash("The quick brown fox jumps over the lazy dog", "6c1b07bc7bbc4be347939ac4a93c437a");
+
+    final byte[] data = new byte[1024];
+    for (int i = 0; i < data.length; ++i) data[i] = (byte) i;
+    for (int chunk = 1; chunk <= 64; ++chunk) {
+      final YajbeHashOutputStream stream = new YajbeHashOutputStream(OutputStream.nullOutputStream());
+      for (int off = 0; off < data.length; off += chunk) {
+        if (chunk == 1) {
+          stream.write(data[off]);
+        } else {
+          stream.write(data, off, Math.min(chunk, data.length - off));
+        }
+      }
+      assertEquals("294c6c31cedcd969c645cc05166c87ed", stream.hash().toHexString());
+    }
+  }
+
+  private static void assertHash(final String text, final String expectedHex) throws IOException {
+    final YajbeHashOutputStream stream = new YajbeHashOutputStream(OutputStream.nullOutputStream());
+    stream.write(text.getBytes(StandardCharsets.UTF_8));
+    assertEquals(expectedHex, stream.hash().toHexString());
+  }
+}
@@ -0,0 +1,133 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import static org.junit.jupiter.api.Assertions.assertArrayEquals;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertNull;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.StringReader;
+import java.util.HexFormat;
+import java.util.Map;
+
+import org.junit.jupiter.api.Test;
+
+import com.fasterxml.jackson.core.JsonGenerator;
+import com.fasterxml.jackson.core.JsonParser;
+import com.fasterxml.jackson.core.JsonToken;
+
+public class TestYajbeChunked extends BaseYajbeTest {
+  @Test
+  public void testChunkedBytes() throws IOException {
+    final byte[] enc = writeBinary(new byte[] { 1, 2, 3 }, -1);
+    assertEquals("108301020301", HexFormat.of().formatHex(enc));
+    assertArrayEquals(new byte[] { 1, 2, 3 }, YAJBE_MAPPER.readValue(enc, byte[].class));
+
+    // empty and multiple chunks
+    assertArrayEquals(new byte[0], YAJBE_MAPPER.readValue(HexFormat.of().parseHex("1001"), byte[].class));
+    assertArrayEquals(new byte[] { 1, 2, 3 }, YAJBE_MAPPER.readValue(HexFormat.of().parseHex("10810182020301"), byte[].class));
+
+    // known length, no chunks
+    assertEquals("83010203", HexFormat.of().formatHex(writeBinary(new byte[] { 1, 2, 3 }, 3)));
+  }
+
+  @Test
+  public void testLargeChunkedBytes() throws IOException {
+    final byte[] data = new byte[(200 << 10) + 13];
+    RANDOM.nextBytes(data);
+
+    final byte[] enc = writeBinary(data, -1);
+    assertArrayEquals(data, YAJBE_MAPPER.readValue(enc, byte[].class));
+
+    // stream the chunks, without materializing the value
+    try (JsonParser parser = YAJBE_MAPPER.createParser(enc)) {
+      assertEquals(JsonToken.VALUE_EMBEDDED_OBJECT, parser.nextToken());
+      final ByteArrayOutputStream out = new ByteArrayOutputStream();
+      assertEquals(data.length, parser.readBinaryValue(out));
+      assertArrayEquals(data, out.toByteArray());
+      assertNull(parser.nextToken());
+    }
+  }
+
+  @Test
+  public void testChunkedString() throws IOException {
+    final byte[] enc = writeString("hello");
+    assertEquals("118568656c6c6f01", HexFormat.of().formatHex(enc));
+    assertEquals("hello", YAJBE_MAPPER.readValue(enc, String.class));
+    assertEquals("", YAJBE_MAPPER.readValue(HexFormat.of().parseHex("1101"), String.class));
+
+    // a surrogate pair across the chunk boundary
+    final String text = "a" + "😀".repeat(20_000);
+    assertEquals(text, YAJBE_MAPPER.readValue(writeString(text), String.class));
+  }
+
+  @Test
+  public void testSkipChunked() throws IOException {
+    final ByteArrayOutputStream baos = new ByteArrayOutputStream();
+    try (JsonGenerator generator = YAJBE_MAPPER.createGenerator(baos)) {
+      generator.writeStartObject();
+      generator.writeFieldName("data");
+      generator.writeBinary(new ByteArrayInputStream(new byte[100_000]), -1);
+      generator.writeFieldName("text");
+      generator.writeString(new StringReader("chunked text"), -1);
+      generator.writeFieldName("n");
+      generator.writeNumber(10);
+      generator.writeEndObject();
+    }
+
+    final Map<?, ?> map = YAJBE_MAPPER.readValue(baos.toByteArray(), Map.class);
+    assertArrayEquals(new byte[100_000], (byte[]) map.get("data"));
+    assertEquals("chunked text", map.get("text"));
+    assertEquals(10, map.get("n"));
+
+    // the chunks not consumed are skipped by nextToken()
+    try (JsonParser parser = YAJBE_MAPPER.createParser(baos.toByteArray())) {
+      assertEquals(JsonToken.START_OBJECT, parser.nextToken());
+      assertEquals(JsonToken.FIELD_NAME, parser.nextToken());
+      assertEquals("data", parser.getCurrentName());
+      assertEquals(JsonToken.VALUE_EMBEDDED_OBJECT, parser.nextToken());
+      assertEquals(JsonToken.FIELD_NAME, parser.nextToken());
+      assertEquals("text", parser.getCurrentName());
+      assertEquals(JsonToken.VALUE_STRING, parser.nextToken());
+      assertEquals(JsonToken.FIELD_NAME, parser.nextToken());
+      assertEquals("n", parser.getCurrentName());
+      assertEquals(JsonToken.VALUE_NUMBER_INT, parser.nextToken());
+      assertEquals(10, parser.getIntValue());
+      assertEquals(JsonToken.END_OBJECT, parser.nextToken());
+    }
+  }
+
+  private byte[] writeBinary(final byte[] data, final int length) throws IOException {
+    final ByteArrayOutputStream baos = new ByteArrayOutputStream();
+    try (JsonGenerator generator = YAJBE_MAPPER.createGenerator(baos)) {
+      generator.writeBinary(new ByteArrayInputStream(data), length);
+    }
+    return baos.toByteArray();
+  }
+
+  private byte[] writeString(final String text) throws IOException {
+    final ByteArrayOutputStream baos = new ByteArrayOutputStream();
+    try (JsonGenerator generator = YAJBE_MAPPER.createGenerator(baos)) {
+      generator.writeString(new StringReader(text), -1);
+    }
+    return baos.toByteArray();
+  }
+}
@@ -0,0 +1,67 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertInstanceOf;
+
+import java.io.IOException;
+import java.util.HexFormat;
+import java.util.List;
+import java.util.Map;
+
+import org.junit.jupiter.api.Test;
+
+public class TestYajbeDocuments extends BaseYajbeTest {
+  record Envelope (String id, YajbeDocument payload) {}
+
+  @Test
+  public void testEmbeddedDocument() throws IOException {
+    final YajbeDocument payload = YajbeDocument.encode(YAJBE_MAPPER, Map.of("x", 1));
+    assertEquals("3f81784001", HexFormat.of().formatHex(payload.data()));
+
+    // the payload is written as-is, with its own field names
+    final byte[] enc = YAJBE_MAPPER.writeValueAsBytes(new Envelope("a", payload));
+    assertEquals("3f826964c16187" + "7061796c6f6164" + "13853f81784001" + "01", HexFormat.of().formatHex(enc));
+
+    final Envelope envelope = YAJBE_MAPPER.readValue(enc, Envelope.class);
+    assertEquals("a", envelope.id());
+    assertEquals(payload, envelope.payload());
+    assertEquals(Map.of("x", 1), envelope.payload().decode(YAJBE_MAPPER, Map.class));
+
+    // untyped: the document is decoded on access
+    final Map<?, ?> map = YAJBE_MAPPER.readValue(enc, Map.class);
+    assertInstanceOf(YajbeDocument.class, map.get("payload"));
+    assertEquals(Map.of("x", 1), ((YajbeDocument) map.get("payload")).decode(YAJBE_MAPPER, Map.class));
+  }
+
+  @Test
+  public void testSplice() throws IOException {
+    final Map<String, Object> value = Map.of("name", "foo", "tags", List.of("a", "b"));
+    final YajbeDocument doc = YajbeDocument.encode(YAJBE_MAPPER, value);
+
+    // the same fragment is spliced many times without encoding it again
+    final List<YajbeDocument> docs = List.of(doc, doc, doc);
+    final byte[] enc = YAJBE_MAPPER.writeValueAsBytes(docs);
+    final YajbeDocument[] dec = YAJBE_MAPPER.readValue(enc, YajbeDocument[].class);
+    assertEquals(3, dec.length);
+    for (final YajbeDocument item: dec) {
+      assertEquals(value, item.decode(YAJBE_MAPPER, Map.class));
+    }
+  }
+}
@@ -0,0 +1,113 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import static org.junit.jupiter.api.Assertions.assertArrayEquals;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HexFormat;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+
+import org.junit.jupiter.api.Test;
+
+import com.fasterxml.jackson.databind.JsonNode;
+import com.fasterxml.jackson.databind.ObjectWriter;
+import com.fasterxml.jackson.databind.cfg.ContextAttributes;
+
+public class TestYajbeDom extends BaseYajbeTest {
+  record DataObject (int a, String b) {}
+
+  private YajbeMapper mapper() {
+    return (YajbeMapper) YAJBE_MAPPER;
+  }
+
+  private void assertDomEncodeDecode(final Object input, final String expectedHex) throws IOException {
+    final byte[] enc = mapper().writeDomAsBytes(input);
+    assertEquals(expectedHex, HexFormat.of().formatHex(enc));
+    assertEquals(input, YAJBE_MAPPER.readValue(enc, Object.class));
+  }
+
+  @Test
+  public void testSimple() throws IOException {
+    assertDomEncodeDecode(Map.of(), "30");
+    assertDomEncodeDecode(Map.of("a", 1), "31816140");
+    assertDomEncodeDecode(Map.of("a", List.of(1, 2, 3)), "31816123404142");
+    assertDomEncodeDecode(Map.of("a", Map.of("l", Map.of("x", 1))), "31816131816c31817840");
+    assertDomEncodeDecode(List.of("abc", 1.5, true), "23c3616263060000000000" + "00f83f03");
+
+    // the output is the same for the JsonNode tree
+    final JsonNode node = YAJBE_MAPPER.valueToTree(Map.of("a", List.of(1, 2, 3)));
+    assertEquals("31816123404142", HexFormat.of().formatHex(mapper().writeDomAsBytes(node)));
+  }
+
+  @Test
+  public void testPojoInMap() throws IOException {
+    final LinkedHashMap<String, Object> input = new LinkedHashMap<>();
+    input.put("obj", new DataObject(1, "x"));
+    input.put("n", 2);
+    final byte[] enc = mapper().writeDomAsBytes(input);
+    assertEquals("32836f626a3f81614081" + "62c17801816e41", HexFormat.of().formatHex(enc));
+    assertEquals(Map.of("obj", Map.of("a", 1, "b", "x"), "n", 2), YAJBE_MAPPER.readValue(enc, Map.class));
+  }
+
+  @Test
+  public void testIntKeys() throws IOException {
+    final byte[] enc = mapper().writeDomAsBytes(Map.of(1, "a"));
+    assertEquals("3140c161", HexFormat.of().formatHex(enc));
+    assertEquals(Map.of("1", "a"), YAJBE_MAPPER.readValue(enc, Map.class));
+  }
+
+  @Test
+  public void testBlobWriter() throws IOException {
+    final ByteArrayOutputStream sidecar = new ByteArrayOutputStream();
+    final ObjectWriter writer = YAJBE_MAPPER.writer(ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_BLOB_WRITER, new YajbeBlobWriter(sidecar, 64)));
+
+    final byte[] data = new byte[100];
+    Arrays.fill(data, (byte) 7);
+    final byte[] enc = mapper().writeDomAsBytes(writer, Map.of("a", data));
+    assertEquals("31816112" + "60" + "584b", HexFormat.of().formatHex(enc));
+
+    // same for the BINARY node, the second blob is after the first one
+    final byte[] encNode = mapper().writeDomAsBytes(writer, YAJBE_MAPPER.valueToTree(Map.of("a", data)));
+    assertEquals("31816112" + "584b" + "584b", HexFormat.of().formatHex(encNode));
+    assertArrayEquals(data, Arrays.copyOfRange(sidecar.toByteArray(), 100, 200));
+  }
+
+  @Test
+  public void testDataSets() throws IOException {
+    final List<Map<String, Object>> rows = new ArrayList<>();
+    for (int i = 0; i < 100; ++i) {
+      final LinkedHashMap<String, Object> row = new LinkedHashMap<>();
+      row.put(generateFieldName(1, 20), randText(RANDOM.nextInt(100)));
+      row.put("id", i);
+      row.put("tags", List.of("t" + (i % 3), "x" + (i % 7)));
+      rows.add(row);
+    }
+    final JsonNode tree = YAJBE_MAPPER.valueToTree(rows);
+    final byte[] enc = mapper().writeDomAsBytes(tree);
+    assertEquals(tree, YAJBE_MAPPER.readTree(enc));
+    assertEquals(rows, YAJBE_MAPPER.readValue(mapper().writeDomAsBytes(rows), List.class));
+  }
+}
@@ -0,0 +1,93 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertTrue;
+
+import java.io.IOException;
+import java.math.BigDecimal;
+import java.util.ArrayList;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+
+import org.junit.jupiter.api.Test;
+
+import com.fasterxml.jackson.databind.JsonNode;
+import com.fasterxml.jackson.databind.ObjectWriter;
+import com.fasterxml.jackson.databind.cfg.ContextAttributes;
+
+public class TestYajbeEncodedSize extends BaseYajbeTest {
+  record DataObject (int a, String text, List<DataObject> children) {}
+
+  private YajbeMapper mapper() {
+    return (YajbeMapper) YAJBE_MAPPER;
+  }
+
+  private void assertEncodedSize(final Object input) throws IOException {
+    final byte[] enc = YAJBE_MAPPER.writeValueAsBytes(input);
+    assertEquals(enc.length, mapper().computeEncodedSize(input));
+    assertTrue(mapper().estimateMaxEncodedSize(input) >= enc.length);
+  }
+
+  @Test
+  public void testSimple() throws IOException {
+    assertEncodedSize(null);
+    assertEncodedSize(true);
+    assertEncodedSize(123456789L);
+    assertEncodedSize(1.5f);
+    assertEncodedSize(new BigDecimal("1234567890.0987654321"));
+    assertEncodedSize("x".repeat(1000));
+    assertEncodedSize(new byte[100_000]);
+    assertEncodedSize(new int[] { 1, 2, 3, 1 << 30 });
+    assertEncodedSize(List.of(1, "abc", List.of(), Map.of("k", 10)));
+  }
+
+  @Test
+  public void testFieldNamesState() throws IOException {
+    final List<Map<String, Object>> input = new ArrayList<>();
+    for (int i = 0; i < 100; ++i) {
+      final Map<String, Object> item = new LinkedHashMap<>();
+      item.put("field_with_long_prefix_" + (i % 7), i);
+      item.put("field_with_long_prefix_and_suffix_" + (i % 13) + "_suffix", "value-" + (i % 5));
+      item.put(generateFieldName(1, 40), randText(RANDOM.nextInt(100)));
+      input.add(item);
+    }
+    assertEncodedSize(input);
+
+    final DataObject obj = new DataObject(1, "aaa", List.of(new DataObject(2, "bbb", List.of()), new DataObject(3, null, null)));
+    assertEncodedSize(obj);
+    assertEncodedSize(YAJBE_MAPPER.valueToTree(input));
+    assertEncodedSize(YAJBE_MAPPER.<JsonNode>valueToTree(obj));
+  }
+
+  @Test
+  public void testProvidedFields() throws IOException {
+    final ContextAttributes attrs = ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_MAP_FIELD_NAMES, new String[] { "hello", "world" });
+
+    final LinkedHashMap<String, Integer> input = new LinkedHashMap<>();
+    input.put("world", 2);
+    input.put("hello", 1);
+
+    final ObjectWriter writer = YAJBE_MAPPER.writer(attrs);
+    assertEquals(writer.writeValueAsBytes(input).length, mapper().computeEncodedSize(writer, input));
+    assertEquals(6, mapper().computeEncodedSize(writer, input));
+  }
+}
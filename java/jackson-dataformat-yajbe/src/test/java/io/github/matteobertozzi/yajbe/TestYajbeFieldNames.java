@@ -23,7 +23,9 @@ import java.io.ByteArrayOutputStream;
 import java.io.IOException;
 import java.util.ArrayList;
 import java.util.HexFormat;
+import java.util.LinkedHashMap;
 import java.util.List;
+import java.util.Map;
 
 import org.junit.jupiter.api.Test;
 
@@ -75,6 +77,82 @@ public class TestYajbeFieldNames extends BaseYajbeTest {
     testEncodeDecode(fields, null);
   }
 
+  @Test
+  public void testObjectShapes() throws IOException {
+    final Map<String, Integer> ab = newMap("a", 1, "b", 2);
+    final Map<String, Integer> ac = newMap("a", 1, "c", 2);
+
+    // the second object is written from the cached shape, same bytes of the indexed names
+    assertHexEquals("223f816140816241013fa040a14101", YAJBE_MAPPER.writeValueAsBytes(List.of(ab, ab)));
+    // diverging shapes with the same first key
+    assertHexEquals("233f816140816241013fa04081634101" + "3fa040a14101", YAJBE_MAPPER.writeValueAsBytes(List.of(ab, ac, ab)));
+
+    // nested objects, prefixes of a shape and objects longer than the shape
+    final ArrayList<Object> items = new ArrayList<>();
+    for (int i = 0; i < 100; ++i) {
+      final LinkedHashMap<String, Object> item = new LinkedHashMap<>();
+      item.put("id", i);
+      if ((i % 3) != 0) item.put("name", "item-" + i);
+      if ((i % 5) == 0) item.put("nested", newMap("id", i, "value", i * 2));
+      if ((i % 7) == 0) item.put("field-" + (i % 4), i);
+      item.put("tail", i % 2 == 0);
+      items.add(item);
+    }
+    final byte[] enc = YAJBE_MAPPER.writeValueAsBytes(items);
+    assertEquals(items, YAJBE_MAPPER.readValue(enc, List.class));
+  }
+
+  @Test
+  public void testObjectShapesSameFirstKey() throws IOException {
+    // records with the same first key and different keys after it, e.g. "type" variants
+    final List<List<String>> variants = List.of(
+      List.of("type", "id", "name"), List.of("type", "id", "size"), List.of("type", "url"),
+      List.of("type", "id", "name", "tags"), List.of("type", "mtime"));
+
+    final ArrayList<String> fieldNames = new ArrayList<>();
+    try (ByteArrayOutputStream baos = new ByteArrayOutputStream()) {
+      final YajbeWriterStream writer = new YajbeWriterStream(baos, new byte[128]);
+      final YajbeFieldNameWriter fieldsWriter = new YajbeFieldNameWriter(writer);
+      for (int i = 0; i < 100; ++i) {
+        final List<String> keys = variants.get(i % variants.size());
+        fieldsWriter.startObject();
+        for (final String key: keys) {
+          fieldsWriter.write(key);
+          fieldNames.add(key);
+        }
+        fieldsWriter.endObject();
+        // a key sequence becomes a shape once it is seen twice
+        if (i == 4) assertEquals(0, fieldsWriter.shapeCount("type"));
+      }
+      // the group is full, the installed shapes are not replaced by the fifth variant
+      assertEquals(4, fieldsWriter.shapeCount("type"));
+      writer.flush();
+
+      final YajbeReader reader = YajbeReader.fromBytes(baos.toByteArray());
+      final YajbeFieldNameReader fieldsReader = new YajbeFieldNameReader(reader);
+      for (int i = 0; reader.peek() >= 0; ++i) {
+        assertEquals(fieldNames.get(i), fieldsReader.read());
+      }
+    }
+
+    final ArrayList<Map<String, Object>> records = new ArrayList<>();
+    for (int i = 0; i < 100; ++i) {
+      final LinkedHashMap<String, Object> record = new LinkedHashMap<>();
+      for (final String key: variants.get((i * 7) % variants.size())) {
+        record.put(key, i);
+      }
+      records.add(record);
+    }
+    assertEquals(records, YAJBE_MAPPER.readValue(YAJBE_MAPPER.writeValueAsBytes(records), List.class));
+  }
+
+  private static Map<String, Integer> newMap(final String k1, final int v1, final String k2, final int v2) {
+    final LinkedHashMap<String, Integer> map = new LinkedHashMap<>();
+    map.put(k1, v1);
+    map.put(k2, v2);
+    return map;
+  }
+
   private static void testEncodeDecode(final List<String> fieldNames, final String expectedHex) throws IOException {
     try (ByteArrayOutputStream baos = new ByteArrayOutputStream()) {
       final YajbeWriterStream writer = new YajbeWriterStream(baos, new byte[128]);
@@ -18,16 +18,24 @@
 package io.github.matteobertozzi.yajbe;
 
 import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertThrows;
 
 import java.io.IOException;
+import java.util.ArrayList;
 import java.util.HashMap;
 import java.util.HexFormat;
 import java.util.LinkedHashMap;
 import java.util.List;
 import java.util.Map;
+import java.util.stream.IntStream;
 
 import org.junit.jupiter.api.Test;
 
+import com.fasterxml.jackson.core.JsonParser;
+import com.fasterxml.jackson.core.JsonToken;
+import com.fasterxml.jackson.core.type.TypeReference;
+import com.fasterxml.jackson.databind.ObjectMapper;
+import com.fasterxml.jackson.databind.ObjectWriter;
 import com.fasterxml.jackson.databind.cfg.ContextAttributes;
 
 public class TestYajbeMaps extends BaseYajbeTest {
@@ -139,4 +147,115 @@ public class TestYajbeMaps extends BaseYajbeTest {
       assertEquals(input, YAJBE_MAPPER.readValue(enc, Map.class));
     }
   }
+
+  @Test
+  public void testIntKeys() throws IOException {
+    final ObjectMapper mapper = new YajbeMapper().registerModule(YajbeMapper.intMapKeysModule());
+
+    final LinkedHashMap<Long, String> input = new LinkedHashMap<>();
+    input.put(1L, "a");
+    input.put(1000L, "k");
+    input.put(-5L, "z");
+    final byte[] enc = mapper.writeValueAsBytes(input);
+    assertHexEquals("3f40c16159cf03c16b65c17a01", enc);
+    assertEquals(input, mapper.readValue(enc, new TypeReference<LinkedHashMap<Long, String>>() {}));
+    assertEquals(Map.of("1", "a", "1000", "k", "-5", "z"), mapper.readValue(enc, Map.class));
+
+    // int keys are not indexed and do not touch the prefix state
+    final LinkedHashMap<Object, Integer> mixed = new LinkedHashMap<>();
+    mixed.put("aaaaaa", 1);
+    mixed.put(10, 2);
+    mixed.put("aaaaab", 3);
+    final byte[] encMixed = mapper.writeValueAsBytes(mixed);
+    assertHexEquals("3f86616161616161404941c105624201", encMixed);
+    assertEquals(Map.of("aaaaaa", 1, "10", 2, "aaaaab", 3), mapper.readValue(encMixed, Map.class));
+
+    // without the module the keys are written as field names
+    assertHexEquals("3f8131c16101", YAJBE_MAPPER.writeValueAsBytes(Map.of(1L, "a")));
+  }
+
+  @Test
+  public void testSizedContainers() throws IOException {
+    final ObjectWriter writer = YAJBE_MAPPER.writer(ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_SIZED_CONTAINERS, 1));
+
+    // the "b" indexed inside the sized map is dropped at the end of it, and written again
+    final LinkedHashMap<String, Object> input = new LinkedHashMap<>();
+    input.put("a", Map.of("b", 1));
+    input.put("b", 2);
+    final byte[] enc = writer.writeValueAsBytes(input);
+    assertHexEquals("3f816115433181624081624101", enc);
+    assertEquals(enc.length, YAJBE_MAPPER.computeEncodedSize(writer, input));
+    assertEquals(input, YAJBE_MAPPER.readValue(enc, Map.class));
+
+    // the root object of unknown size gets the count, as the nested sized one
+    final DataObject pojo = new DataObject(1, new DataObject(2, null));
+    final byte[] encPojo = writer.writeValueAsBytes(pojo);
+    assertEquals(encPojo.length, YAJBE_MAPPER.computeEncodedSize(writer, pojo));
+    assertEquals(pojo, YAJBE_MAPPER.readValue(encPojo, DataObject.class));
+
+    // the sized map is skipped without reading it, the field names that follow are the same
+    try (JsonParser parser = YAJBE_MAPPER.createParser(enc)) {
+      assertEquals(JsonToken.START_OBJECT, parser.nextToken());
+      assertEquals(JsonToken.FIELD_NAME, parser.nextToken());
+      assertEquals("a", parser.getCurrentName());
+      assertEquals(JsonToken.START_OBJECT, parser.nextToken());
+      assertEquals(JsonToken.END_OBJECT, parser.skipChildren().currentToken());
+      assertEquals(JsonToken.FIELD_NAME, parser.nextToken());
+      assertEquals("b", parser.getCurrentName());
+      assertEquals(JsonToken.VALUE_NUMBER_INT, parser.nextToken());
+      assertEquals(2, parser.getIntValue());
+      assertEquals(JsonToken.END_OBJECT, parser.nextToken());
+    }
+
+    // records and their payload are sized, read the names skipping the payloads
+    final ArrayList<Map<String, Object>> records = new ArrayList<>();
+    for (int i = 0; i < 100; ++i) {
+      final LinkedHashMap<String, Object> item = new LinkedHashMap<>();
+      item.put("id", i);
+      item.put("payload", Map.of("name", "item-" + i, "tags", List.of("x", "y"), "text", randText(40 + i)));
+      item.put("name", "n" + i);
+      records.add(item);
+    }
+    final ObjectWriter deepWriter = YAJBE_MAPPER.writer(ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_SIZED_CONTAINERS, 2));
+    final byte[] encRecords = deepWriter.writeValueAsBytes(records);
+    assertEquals(encRecords.length, YAJBE_MAPPER.computeEncodedSize(deepWriter, records));
+    assertEquals(records, YAJBE_MAPPER.readValue(encRecords, List.class));
+
+    try (JsonParser parser = YAJBE_MAPPER.createParser(encRecords)) {
+      assertEquals(JsonToken.START_ARRAY, parser.nextToken());
+      for (int i = 0; i < 100; ++i) {
+        assertEquals(JsonToken.START_OBJECT, parser.nextToken());
+        if ((i & 1) == 1) {
+          parser.skipChildren();
+          continue;
+        }
+        while (parser.nextToken() == JsonToken.FIELD_NAME) {
+          final String name = parser.getCurrentName();
+          parser.nextToken();
+          switch (name) {
+            case "id" -> assertEquals(i, parser.getIntValue());
+            case "payload" -> parser.skipChildren();
+            case "name" -> assertEquals("n" + i, parser.getText());
+          }
+        }
+        assertEquals(JsonToken.END_OBJECT, parser.currentToken());
+      }
+      assertEquals(JsonToken.END_ARRAY, parser.nextToken());
+    }
+
+    // the buffer is full, the sized array is written with a zero length (not skippable)
+    final ObjectWriter smallWriter = YAJBE_MAPPER.writer(ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_COUNTED_CONTAINERS, 16)
+      .withSharedAttribute(YajbeMapper.CONFIG_SIZED_CONTAINERS, 1));
+    final Map<String, Object> large = Map.of("a", IntStream.rangeClosed(1, 20).boxed().toList());
+    final byte[] encLarge = smallWriter.writeValueAsBytes(large);
+    assertHexEquals("3f81611560" + "2b0a" + "404142434445464748494a4b4c4d4e4f50515253" + "01", encLarge);
+    assertEquals(large, YAJBE_MAPPER.readValue(encLarge, Map.class));
+
+    // the sized head must be followed by an array or a map
+    assertThrows(IOException.class, () -> YAJBE_MAPPER.readValue(HexFormat.of().parseHex("156040"), Object.class));
+    assertThrows(IOException.class, () -> YAJBE_MAPPER.readValue(HexFormat.of().parseHex("31816115604101"), Map.class));
+  }
 }
@@ -0,0 +1,263 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import static org.junit.jupiter.api.Assertions.assertArrayEquals;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertFalse;
+import static org.junit.jupiter.api.Assertions.assertNull;
+import static org.junit.jupiter.api.Assertions.assertThrows;
+import static org.junit.jupiter.api.Assertions.assertTrue;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HexFormat;
+import java.util.List;
+import java.util.Map;
+import java.util.function.Predicate;
+import java.util.stream.IntStream;
+
+import org.junit.jupiter.api.Test;
+
+public class TestYajbeRecords extends BaseYajbeTest {
+  @Test
+  public void testSimple() throws IOException {
+    final ByteArrayOutputStream out = new ByteArrayOutputStream();
+    try (YajbeRecordWriter writer = new YajbeRecordWriter(YAJBE_MAPPER, out)) {
+      writer.writeRaw(new byte[] { 0x40 }, 0, 1);
+    }
+    // length=1, payload=40 (int 1), crc32c(40)
+    assertEquals("01000000" + "40" + "ed4e0613", HexFormat.of().formatHex(out.toByteArray()));
+  }
+
+  @Test
+  public void testWriteRead() throws IOException {
+    final ByteArrayOutputStream out = new ByteArrayOutputStream();
+    try (YajbeRecordWriter writer = new YajbeRecordWriter(YAJBE_MAPPER, out)) {
+      for (int i = 0; i < 1000; ++i) {
+        writer.write(Map.of("id", i, "text", randText(RANDOM.nextInt(20_000)), "list", List.of(i, i + 1)));
+      }
+      assertEquals(1000, writer.recordCount());
+    }
+
+    final byte[] data = out.toByteArray();
+    try (YajbeRecordReader reader = new YajbeRecordReader(YAJBE_MAPPER, new ByteArrayInputStream(data))) {
+      for (int i = 0; i < 1000; ++i) {
+        final Map<?, ?> value = reader.nextValue(Map.class);
+        assertEquals(i, value.get("id"));
+        assertEquals(List.of(i, i + 1), value.get("list"));
+      }
+      assertNull(reader.nextRecord());
+    }
+
+    assertEquals(1000, YajbeRecordReader.verify(ByteBuffer.wrap(data), 1));
+    assertEquals(1000, YajbeRecordReader.verify(ByteBuffer.wrap(data), 1 << 16));
+    assertEquals(1000, YajbeRecordReader.verify(ByteBuffer.allocateDirect(data.length).put(data).flip(), 1 << 20));
+  }
+
+  @Test
+  public void testCorruption() throws IOException {
+    final ByteArrayOutputStream out = new ByteArrayOutputStream();
+    try (YajbeRecordWriter writer = new YajbeRecordWriter(YAJBE_MAPPER, out)) {
+      for (int i = 0; i < 100; ++i) {
+        writer.write(List.of(i, "value-" + i));
+      }
+    }
+
+    final byte[] data = out.toByteArray();
+    data[data.length / 2] ^= 0x10;
+    assertThrows(IOException.class, () -> YajbeRecordReader.verify(ByteBuffer.wrap(data), 256));
+    assertThrows(IOException.class, () -> {
+      try (YajbeRecordReader reader = new YajbeRecordReader(YAJBE_MAPPER, new ByteArrayInputStream(data))) {
+        while (reader.nextRecord() != null) {
+          // no-op
+        }
+      }
+    });
+
+    final byte[] truncated = Arrays.copyOf(out.toByteArray(), data.length - 1);
+    assertThrows(IOException.class, () -> YajbeRecordReader.verify(ByteBuffer.wrap(truncated), 256));
+  }
+
+  @Test
+  public void testRawRecords() throws IOException {
+    final byte[] enc = YAJBE_MAPPER.writeValueAsBytes(Map.of("a", 1));
+    final ByteArrayOutputStream out = new ByteArrayOutputStream();
+    try (YajbeRecordWriter writer = new YajbeRecordWriter(YAJBE_MAPPER, out)) {
+      writer.writeRaw(enc, 0, enc.length);
+      writer.write(Map.of("a", 1));
+    }
+
+    try (YajbeRecordReader reader = new YajbeRecordReader(YAJBE_MAPPER, new ByteArrayInputStream(out.toByteArray()))) {
+      assertArrayEquals(enc, reader.nextRecord());
+      assertArrayEquals(enc, reader.nextRecord());
+      assertNull(reader.nextRecord());
+    }
+  }
+
+  @Test
+  public void testRecordIndex() throws IOException {
+    final ByteArrayOutputStream out = new ByteArrayOutputStream();
+    int expectedIndexed = 0;
+    try (YajbeRecordWriter writer = new YajbeRecordWriter(YAJBE_MAPPER, out)) {
+      for (int i = 0; i < 1000; ++i) {
+        if ((i % 7) == 0) {
+          writer.write(Map.of("seq", i, "tags", List.of(Map.of("id", i % 100))));
+        } else {
+          final Map<String, Object> user = Map.of("id", (i % 100) - 50, "name", "user-" + (i % 100));
+          writer.write(Map.of("seq", i, "tags", List.of(Map.of("id", -1)), "user", user));
+          expectedIndexed++;
+        }
+      }
+    }
+
+    final ByteBuffer records = ByteBuffer.wrap(out.toByteArray());
+    final ByteArrayOutputStream idOut = new ByteArrayOutputStream();
+    assertEquals(expectedIndexed, YajbeRecordIndex.build(YAJBE_MAPPER, records, "user.id", 512, idOut));
+    final ByteArrayOutputStream nameOut = new ByteArrayOutputStream();
+    assertEquals(expectedIndexed, YajbeRecordIndex.build(YAJBE_MAPPER, records, "user.name", 1 << 20, nameOut));
+
+    final YajbeRecordIndex idIndex = new YajbeRecordIndex(ByteBuffer.wrap(idOut.toByteArray()));
+    final YajbeRecordIndex nameIndex = new YajbeRecordIndex(ByteBuffer.wrap(nameOut.toByteArray()));
+    assertEquals(expectedIndexed, idIndex.size());
+    for (final int userId: new int[] { -50, -8, 0, 42, 49 }) {
+      final long[] offsets = idIndex.lookup(userId);
+      assertArrayEquals(offsets, nameIndex.lookup("user-" + (userId + 50)));
+      assertEquals(10 - (int) IntStream.range(0, 10).filter(k -> ((k * 100 + userId + 50) % 7) == 0).count(), offsets.length);
+
+      long lastOffset = -1;
+      for (final long offset: offsets) {
+        assertTrue(offset > lastOffset);
+        lastOffset = offset;
+        final Map<?, ?> value = YAJBE_MAPPER.readValue(YajbeRecordReader.readRecord(records, offset), Map.class);
+        assertEquals(userId, ((Map<?, ?>) value.get("user")).get("id"));
+      }
+    }
+    assertEquals(0, idIndex.lookup(1000).length);
+    assertEquals(0, nameIndex.lookup("user-x").length);
+  }
+
+  @Test
+  public void testBlockStats() throws IOException {
+    final YajbeBlockStats.Collector collector = new YajbeBlockStats.Collector(YAJBE_MAPPER,
+      List.of("ts", "user.age", "score"), List.of("user.name", "level"), 1024, 1024);
+    final ByteArrayOutputStream out = new ByteArrayOutputStream();
+    try (YajbeRecordWriter writer = new YajbeRecordWriter(YAJBE_MAPPER, out)) {
+      writer.setBlockStats(collector);
+      for (int i = 0; i < 1000; ++i) {
+        final Map<String, Object> user = Map.of("name", "user-" + (i / 100), "age", 20 + (i % 50));
+        final double score = (i == 250) ? Double.NaN : i * 0.5;
+        writer.write(Map.of("ts", 1000 + i, "level", (i == 500) ? "ERROR" : "INFO", "user", user, "tags", List.of("a", "b"), "score", score));
+      }
+    }
+
+    final ByteArrayOutputStream statsOut = new ByteArrayOutputStream();
+    collector.finish().writeTo(YAJBE_MAPPER, statsOut);
+    final YajbeBlockStats stats = YajbeBlockStats.readFrom(YAJBE_MAPPER, new ByteArrayInputStream(statsOut.toByteArray()));
+    assertTrue(stats.blocks().size() > 10);
+    assertEquals(1000, stats.blocks().stream().mapToInt(YajbeBlockStats.Block::recordCount).sum());
+
+    final byte[] data = out.toByteArray();
+    assertEquals(data.length, stats.blocks().get(stats.blocks().size() - 1).endOffset());
+
+    // the pruned scan must find the same records of the full scan
+    assertScan(data, stats, stats.range("ts", 1200, 1210), value -> ((Number) value.get("ts")).intValue() >= 1200 && ((Number) value.get("ts")).intValue() <= 1210);
+    assertScan(data, stats, stats.contains("level", "ERROR"), value -> "ERROR".equals(value.get("level")));
+    assertScan(data, stats, stats.contains("user.name", "user-3"), value -> "user-3".equals(((Map<?, ?>) value.get("user")).get("name")));
+    assertScan(data, stats, stats.range("user.age", 100, 200), value -> false);
+    // the NaN is not collected, the block with it keeps the range of the other records
+    assertScan(data, stats, stats.range("score", 120, 130), value -> {
+      final double score = ((Number) value.get("score")).doubleValue();
+      return score >= 120 && score <= 130;
+    });
+    assertTrue(stats.select(stats.range("ts", 1200, 1210)).size() < 3);
+    assertTrue(stats.select(stats.contains("level", "FATAL")).size() < stats.blocks().size());
+    assertEquals(stats.blocks().size(), stats.select(stats.range("unknown", 0, 1)).size());
+  }
+
+  record Event (long ts, String level, Map<String, Object> user, List<Integer> tags) {}
+
+  @Test
+  public void testBlockStatsEncodedRecords() throws IOException {
+    // the stats collected while encoding are the same of the ones collected walking the encoded records
+    final List<String> numericFields = List.of("ts", "user.age", "tags");
+    final List<String> bloomFields = List.of("level", "user.name", "user.id");
+    final YajbeBlockStats.Collector encodeCollector = new YajbeBlockStats.Collector(YAJBE_MAPPER, numericFields, bloomFields, 512, 256);
+    final YajbeBlockStats.Collector rawCollector = new YajbeBlockStats.Collector(YAJBE_MAPPER, numericFields, bloomFields, 512, 256);
+    final ByteArrayOutputStream encodeOut = new ByteArrayOutputStream();
+    final ByteArrayOutputStream rawOut = new ByteArrayOutputStream();
+    try (YajbeRecordWriter encodeWriter = new YajbeRecordWriter(YAJBE_MAPPER, encodeOut);
+         YajbeRecordWriter rawWriter = new YajbeRecordWriter(YAJBE_MAPPER, rawOut)) {
+      encodeWriter.setBlockStats(encodeCollector);
+      rawWriter.setBlockStats(rawCollector);
+      for (int i = 0; i < 200; ++i) {
+        final Map<String, Object> user = Map.of("name", "user-" + (i % 7), "age", 20 + (i % 50), "id", (long) i,
+          "tags", Map.of("age", -i));
+        final Event event = new Event(1000 + i, (i % 10 == 0) ? "WARN" : "INFO", user, List.of(i, -i));
+        encodeWriter.write(event);
+        final byte[] enc = YAJBE_MAPPER.writeValueAsBytes(event);
+        rawWriter.writeRaw(enc, 0, enc.length);
+      }
+    }
+    assertArrayEquals(encodeOut.toByteArray(), rawOut.toByteArray());
+
+    final List<YajbeBlockStats.Block> encodeBlocks = encodeCollector.finish().blocks();
+    final List<YajbeBlockStats.Block> rawBlocks = rawCollector.finish().blocks();
+    assertEquals(rawBlocks.size(), encodeBlocks.size());
+    for (int i = 0; i < rawBlocks.size(); ++i) {
+      final YajbeBlockStats.Block encodeBlock = encodeBlocks.get(i);
+      final YajbeBlockStats.Block rawBlock = rawBlocks.get(i);
+      assertEquals(rawBlock.startOffset(), encodeBlock.startOffset());
+      assertEquals(rawBlock.recordCount(), encodeBlock.recordCount());
+      assertEquals(rawBlock.min(), encodeBlock.min());
+      assertEquals(rawBlock.max(), encodeBlock.max());
+      // the values inside arrays are not collected
+      assertFalse(encodeBlock.min().containsKey("tags"));
+      for (final String field: bloomFields) {
+        assertArrayEquals(rawBlock.bloom().get(field), encodeBlock.bloom().get(field));
+      }
+    }
+  }
+
+  private void assertScan(final byte[] data, final YajbeBlockStats stats, final Predicate<YajbeBlockStats.Block> blockFilter,
+      final Predicate<Map<?, ?>> filter) throws IOException {
+    final ArrayList<Map<?, ?>> expected = new ArrayList<>();
+    try (YajbeRecordReader reader = new YajbeRecordReader(YAJBE_MAPPER, new ByteArrayInputStream(data))) {
+      Map<?, ?> value;
+      while ((value = reader.nextValue(Map.class)) != null) {
+        if (filter.test(value)) expected.add(value);
+      }
+    }
+
+    final ArrayList<Map<?, ?>> found = new ArrayList<>();
+    for (final YajbeBlockStats.Block block: stats.select(blockFilter)) {
+      final int length = (int) (block.endOffset() - block.startOffset());
+      try (YajbeRecordReader reader = new YajbeRecordReader(YAJBE_MAPPER, new ByteArrayInputStream(data, (int) block.startOffset(), length))) {
+        Map<?, ?> value;
+        while ((value = reader.nextValue(Map.class)) != null) {
+          if (filter.test(value)) found.add(value);
+        }
+      }
+    }
+    assertEquals(expected, found);
+  }
+}
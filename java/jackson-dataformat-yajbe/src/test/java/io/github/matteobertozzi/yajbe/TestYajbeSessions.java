@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertFalse;
+import static org.junit.jupiter.api.Assertions.assertThrows;
+import static org.junit.jupiter.api.Assertions.assertTrue;
+
+import java.io.IOException;
+import java.util.HexFormat;
+import java.util.Map;
+
+import org.junit.jupiter.api.Test;
+
+public class TestYajbeSessions extends BaseYajbeTest {
+  @Test
+  public void testFieldNamesAcrossMessages() throws IOException {
+    final YajbeSessionWriter writer = new YajbeSessionWriter(YAJBE_MAPPER);
+    final YajbeSessionReader reader = new YajbeSessionReader(YAJBE_MAPPER);
+
+    final byte[] m1 = writer.encode(Map.of("a", 1));
+    final byte[] m2 = writer.encode(Map.of("a", 2));
+    writer.sync();
+    final byte[] m3 = writer.encode(Map.of("a", 3));
+    assertEquals(3, writer.messageCount());
+
+    // the first message is a sync point, the next one uses the indexed field name
+    assertEquals("14" + "3f81614001", HexFormat.of().formatHex(m1));
+    assertEquals("3fa04101", HexFormat.of().formatHex(m2));
+    assertEquals("14" + "3f81614201", HexFormat.of().formatHex(m3));
+
+    assertEquals(Map.of("a", 1), reader.decode(m1, Map.class));
+    assertEquals(Map.of("a", 2), reader.decode(m2, Map.class));
+    assertEquals(Map.of("a", 3), reader.decode(m3, Map.class));
+    assertEquals(3, reader.messageCount());
+  }
+
+  @Test
+  public void testResync() throws IOException {
+    final YajbeSessionWriter writer = new YajbeSessionWriter(YAJBE_MAPPER);
+    final YajbeSessionReader reader = new YajbeSessionReader(YAJBE_MAPPER);
+
+    final byte[] m1 = writer.encode(Map.of("a", 1));
+    writer.encode(Map.of("b", 2)); // lost
+    final byte[] m3 = writer.encode(Map.of("b", 3));
+
+    assertEquals(Map.of("a", 1), reader.decode(m1, Map.class));
+    assertTrue(reader.isSynced());
+
+    // the gap is detected by the application (e.g. sequence id), the reader waits for a sync point
+    reader.resync();
+    assertFalse(reader.isSynced());
+    assertThrows(IOException.class, () -> reader.decode(m3, Map.class));
+
+    writer.sync();
+    final byte[] m4 = writer.encode(Map.of("b", 4));
+    assertEquals(Map.of("b", 4), reader.decode(m4, Map.class));
+    assertTrue(reader.isSynced());
+
+    final byte[] m5 = writer.encode(Map.of("a", 5, "b", 5));
+    assertEquals(Map.of("a", 5, "b", 5), reader.decode(m5, Map.class));
+  }
+
+  @Test
+  public void testSyncEveryMessages() throws IOException {
+    final YajbeSessionWriter writer = new YajbeSessionWriter(YAJBE_MAPPER.writer(), 3);
+    final YajbeSessionReader reader = new YajbeSessionReader(YAJBE_MAPPER);
+    for (int i = 0; i < 10; ++i) {
+      final Map<String, Object> message = Map.of("id", i, "status", "OK", "value", RANDOM.nextInt());
+      final byte[] data = writer.encode(message);
+      assertEquals((i % 3) == 0, data[0] == 0x14);
+      assertEquals(message, reader.decode(data, Map.class));
+    }
+    assertEquals(10, reader.messageCount());
+  }
+}
@@ -1,17 +1,30 @@
 package io.github.matteobertozzi.yajbe;
 
 import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertNotNull;
+import static org.junit.jupiter.api.Assertions.assertNull;
+import static org.junit.jupiter.api.Assertions.assertTrue;
 
 import java.io.ByteArrayOutputStream;
+import java.io.FileOutputStream;
 import java.io.IOException;
+import java.io.OutputStream;
+import java.nio.file.Files;
+import java.nio.file.Path;
 import java.util.ArrayList;
 import java.util.HexFormat;
+import java.util.List;
 import java.util.Map;
 
 import org.junit.jupiter.api.Test;
 
 import com.fasterxml.jackson.core.JsonGenerator;
 import com.fasterxml.jackson.core.JsonParser;
+import com.fasterxml.jackson.core.JsonToken;
+import com.fasterxml.jackson.databind.ObjectWriter;
+import com.fasterxml.jackson.databind.cfg.ContextAttributes;
+
+import io.github.matteobertozzi.yajbe.YajbeStreamWriter.FlushPolicy;
 
 public class TestYajbeStreaming extends BaseYajbeTest {
   @Test
@@ -40,4 +53,186 @@ public class TestYajbeStreaming extends BaseYajbeTest {
       }
     }
   }
+
+  @Test
+  public void testStreamWriter() throws IOException {
+    final FlushCountingStream stream = new FlushCountingStream();
+    final FlushPolicy policy = new FlushPolicy(1 << 20, 0, false, 2);
+    try (YajbeStreamWriter writer = new YajbeStreamWriter(YAJBE_MAPPER.writer(), stream, policy)) {
+      writer.write(Map.of("a", 1));
+      writer.write(Map.of("a", 2));
+      writer.write(Map.of("a", 3)); // after the reset the field name is written again
+      assertEquals(3, writer.valueCount());
+      assertEquals(0, stream.flushCount);
+
+      writer.flush();
+      assertEquals(1, stream.flushCount);
+      assertEquals("2f" + "3f81614001" + "3fa04101" + "14" + "3f81614201", HexFormat.of().formatHex(stream.toByteArray()));
+    }
+    assertEquals("2f" + "3f81614001" + "3fa04101" + "14" + "3f81614201" + "01", HexFormat.of().formatHex(stream.toByteArray()));
+    assertEquals(List.of(Map.of("a", 1), Map.of("a", 2), Map.of("a", 3)), YAJBE_MAPPER.readValue(stream.toByteArray(), List.class));
+  }
+
+  @Test
+  public void testStreamWriterCountedContainers() throws IOException {
+    // the values are buffered until closed, but the root array is not: flush/sync write the values
+    final ObjectWriter counted = YAJBE_MAPPER.writer(ContextAttributes.getEmpty()
+      .withSharedAttribute(YajbeMapper.CONFIG_COUNTED_CONTAINERS, 1 << 20));
+    final FlushCountingStream stream = new FlushCountingStream();
+    try (YajbeStreamWriter writer = new YajbeStreamWriter(counted, stream, new FlushPolicy(1 << 20, 0, false, 0))) {
+      writer.write(Map.of("a", 1));
+      writer.write(List.of(1, 2).iterator());
+      writer.sync();
+      assertEquals("2f" + "31816140" + "224041", HexFormat.of().formatHex(stream.toByteArray()));
+    }
+    assertEquals("2f" + "31816140" + "224041" + "01", HexFormat.of().formatHex(stream.toByteArray()));
+  }
+
+  @Test
+  public void testStreamWriterFlushPolicy() throws IOException {
+    final FlushCountingStream stream = new FlushCountingStream();
+    final FlushPolicy policy = new FlushPolicy(1024, 0, false, 100);
+    final ArrayList<Map<String, Object>> events = new ArrayList<>();
+    try (YajbeStreamWriter writer = new YajbeStreamWriter(YAJBE_MAPPER.writer(), stream, policy)) {
+      for (int i = 0; i < 1000; ++i) {
+        final Map<String, Object> event = Map.of("ts", i, "level", "INFO", "msg", "event " + i + " " + "x".repeat(i % 500));
+        writer.write(event);
+        events.add(event);
+      }
+      // the writer is flushed every ~1K, the values are already readable by the consumer
+      assertTrue(stream.flushCount > 10, "flushCount " + stream.flushCount);
+      // the bytes still buffered by the encoder are pending too: a flush every 1K + at most one value (< 600 bytes)
+      int lastSize = 0;
+      for (final int size: stream.flushSizes) {
+        final int interval = size - lastSize;
+        assertTrue(interval >= 1024 && interval < 1024 + 600, "flush interval " + interval);
+        lastSize = size;
+      }
+      assertTrue(stream.size() - lastSize < 1024, "pending " + (stream.size() - lastSize));
+    }
+
+    try (JsonParser parser = YAJBE_MAPPER.createParser(stream.toByteArray())) {
+      assertEquals(JsonToken.START_ARRAY, parser.nextToken());
+      for (final Map<String, Object> event: events) {
+        assertEquals(JsonToken.START_OBJECT, parser.nextToken());
+        assertEquals(event, parser.readValueAs(Map.class));
+      }
+      assertEquals(JsonToken.END_ARRAY, parser.nextToken());
+    }
+  }
+
+  @Test
+  public void testTailFollow() throws Exception {
+    final Path path = Files.createTempFile("yajbe-tail", ".bin");
+    try (YajbeTailInputStream tail = new YajbeTailInputStream(path, 0, 50)) {
+      final Thread writerThread = new Thread(() -> {
+        try (YajbeStreamWriter writer = new YajbeStreamWriter(YAJBE_MAPPER, new FileOutputStream(path.toFile()))) {
+          for (int i = 0; i < 100; ++i) {
+            writer.write(Map.of("seq", i, "msg", "event " + i));
+            if ((i % 10) == 0) {
+              writer.flush();
+              Thread.sleep(5);
+            }
+          }
+        } catch (final Exception e) {
+          throw new RuntimeException(e);
+        }
+      });
+      writerThread.start();
+
+      // the values are decoded as they land, the field names are carried across the appends
+      try (JsonParser parser = YAJBE_MAPPER.createParser(tail)) {
+        assertEquals(JsonToken.START_ARRAY, parser.nextToken());
+        for (int i = 0; i < 100; ++i) {
+          assertEquals(JsonToken.START_OBJECT, parser.nextToken());
+          assertEquals(Map.of("seq", i, "msg", "event " + i), parser.readValueAs(Map.class));
+        }
+        assertEquals(JsonToken.END_ARRAY, parser.nextToken());
+      }
+      writerThread.join();
+    } finally {
+      Files.delete(path);
+    }
+  }
+
+  @Test
+  public void testTailFollowPartialRecords() throws Exception {
+    final ByteArrayOutputStream records = new ByteArrayOutputStream();
+    try (YajbeRecordWriter writer = new YajbeRecordWriter(YAJBE_MAPPER, records)) {
+      for (int i = 0; i < 10; ++i) {
+        writer.write(Map.of("seq", i));
+      }
+    }
+    final byte[] data = records.toByteArray();
+
+    final Path path = Files.createTempFile("yajbe-tail", ".bin");
+    try (YajbeTailInputStream tail = new YajbeTailInputStream(path, 0, 50)) {
+      final Thread writerThread = new Thread(() -> {
+        try (OutputStream stream = new FileOutputStream(path.toFile())) {
+          // the records are appended in pieces, splitting headers and payloads
+          for (int off = 0; off < data.length; off += 5) {
+            stream.write(data, off, Math.min(5, data.length - off));
+            stream.flush();
+            Thread.sleep(2);
+          }
+          Thread.sleep(50);
+          tail.close();
+        } catch (final Exception e) {
+          throw new RuntimeException(e);
+        }
+      });
+      writerThread.start();
+
+      final YajbeRecordReader reader = new YajbeRecordReader(YAJBE_MAPPER, tail);
+      for (int i = 0; i < 10; ++i) {
+        assertEquals(Map.of("seq", i), reader.nextValue(Map.class));
+      }
+      // closed while waiting for the next record
+      assertNull(reader.nextRecord());
+      writerThread.join();
+    } finally {
+      Files.delete(path);
+    }
+  }
+
+  @Test
+  public void testEnumAutotuner() throws IOException {
+    final List<Map<String, Object>> repeated = new ArrayList<>();
+    final List<Map<String, Object>> unique = new ArrayList<>();
+    for (int i = 0; i < 300; ++i) {
+      repeated.add(Map.of("host", "server-" + (i % 4), "level", (i % 10 == 0) ? "ERROR" : "INFO", "seq", i));
+      unique.add(Map.of("id", randText(16), "seq", i));
+    }
+
+    final YajbeEnumAutotuner tuner = new YajbeEnumAutotuner(YAJBE_MAPPER);
+    assertNotNull(tuner.tune(repeated));
+    assertNull(tuner.tune(unique));
+
+    final ByteArrayOutputStream plain = new ByteArrayOutputStream();
+    try (YajbeStreamWriter writer = new YajbeStreamWriter(YAJBE_MAPPER, plain)) {
+      for (final Map<String, Object> value: repeated) writer.write(value);
+    }
+
+    final ByteArrayOutputStream tuned = new ByteArrayOutputStream();
+    try (YajbeStreamWriter writer = new YajbeStreamWriter(YAJBE_MAPPER, tuned)) {
+      final YajbeEnumAutotuner autotuner = new YajbeEnumAutotuner(YAJBE_MAPPER.writer(), YajbeEnumAutotuner.DEFAULT_CANDIDATES, 50, 100, 0.02);
+      writer.setEnumAutotuner(autotuner);
+      for (final Map<String, Object> value: repeated) writer.write(value);
+      assertNotNull(autotuner.config());
+    }
+
+    assertTrue(tuned.size() < plain.size(), "tuned " + tuned.size() + " plain " + plain.size());
+    assertEquals(repeated, YAJBE_MAPPER.readValue(tuned.toByteArray(), List.class));
+  }
+
+  private static final class FlushCountingStream extends ByteArrayOutputStream {
+    private final ArrayList<Integer> flushSizes = new ArrayList<>();
+    private int flushCount;
+
+    @Override
+    public void flush() {
+      flushSizes.add(size());
+      flushCount++;
+    }
+  }
 }
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe;
+
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertNotSame;
+import static org.junit.jupiter.api.Assertions.assertSame;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.ObjectInputStream;
+import java.io.ObjectOutputStream;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.List;
+
+import org.junit.jupiter.api.Test;
+
+import com.fasterxml.jackson.core.type.TypeReference;
+
+public class TestYajbeStringIntern extends BaseYajbeTest {
+  private static final TypeReference<List<String>> STRING_LIST = new TypeReference<>() {};
+
+  @Test
+  public void testSharedDecodedValues() throws IOException {
+    final YajbeStringInternTable internTable = new YajbeStringInternTable(1024, 64);
+    final YajbeMapper mapper = new YajbeMapper(new YajbeFactory(null, internTable));
+
+    final List<String> input = new ArrayList<>();
+    for (int i = 0; i < 100; ++i) {
+      input.add("value-" + (i % 10));
+    }
+    input.add("x".repeat(100));
+    input.add("x".repeat(100));
+
+    final byte[] enc = YAJBE_MAPPER.writeValueAsBytes(input);
+    final List<String> fromBytes = mapper.readValue(enc, STRING_LIST);
+    final List<String> fromStream = mapper.readValue(new ByteArrayInputStream(enc), STRING_LIST);
+    assertEquals(input, fromBytes);
+    assertEquals(input, fromStream);
+    for (int i = 10; i < 100; ++i) {
+      assertSame(fromBytes.get(i % 10), fromBytes.get(i));
+      assertSame(fromBytes.get(i), fromStream.get(i));
+    }
+
+    // longer than maxLength, not interned
+    assertNotSame(fromBytes.get(100), fromBytes.get(101));
+  }
+
+  @Test
+  public void testFactorySerialization() throws Exception {
+    final ByteArrayOutputStream buf = new ByteArrayOutputStream();
+    try (ObjectOutputStream out = new ObjectOutputStream(buf)) {
+      out.writeObject(new YajbeFactory(null, new YajbeStringInternTable(1024, 64)));
+    }
+
+    // the table is not serialized, the factory gets a new empty one
+    final YajbeFactory factory;
+    try (ObjectInputStream in = new ObjectInputStream(new ByteArrayInputStream(buf.toByteArray()))) {
+      factory = (YajbeFactory) in.readObject();
+    }
+    final YajbeMapper mapper = new YajbeMapper(factory);
+    final byte[] enc = YAJBE_MAPPER.writeValueAsBytes(List.of("value-0", "value-1"));
+    final List<String> first = mapper.readValue(enc, STRING_LIST);
+    final List<String> second = mapper.readValue(enc, STRING_LIST);
+    assertEquals(List.of("value-0", "value-1"), second);
+    assertSame(first.get(0), second.get(0));
+    assertSame(first.get(1), second.get(1));
+  }
+
+  @Test
+  public void testBoundedEviction() {
+    final YajbeStringInternTable internTable = new YajbeStringInternTable(64, 32);
+    assertEquals(64, internTable.capacity());
+
+    final byte[] hot = "hot-value".getBytes(StandardCharsets.UTF_8);
+    final String hotValue = internTable.intern(hot, 0, hot.length);
+    for (int i = 0; i < 10_000; ++i) {
+      final byte[] key = ("key-" + i).getBytes(StandardCharsets.UTF_8);
+      final String value = internTable.intern(key, 0, key.length);
+      assertEquals("key-" + i, value);
+      assertSame(value, internTable.intern(key, 0, key.length));
+    }
+
+    // the table is bounded, the value may have been evicted but the content is always correct
+    assertEquals(hotValue, internTable.intern(hot, 0, hot.length));
+
+    internTable.clear();
+    final byte[] key = "key-0".getBytes(StandardCharsets.UTF_8);
+    assertEquals("key-0", internTable.intern(key, 0, key.length));
+  }
+}
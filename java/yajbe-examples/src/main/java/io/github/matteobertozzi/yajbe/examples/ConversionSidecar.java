@@ -0,0 +1,350 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe.examples;
+
+import java.io.ByteArrayOutputStream;
+import java.io.Closeable;
+import java.io.IOException;
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.net.SocketAddress;
+import java.net.StandardProtocolFamily;
+import java.net.UnixDomainSocketAddress;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.channels.ClosedChannelException;
+import java.nio.channels.SelectionKey;
+import java.nio.channels.Selector;
+import java.nio.channels.ServerSocketChannel;
+import java.nio.channels.SocketChannel;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.util.Iterator;
+import java.util.concurrent.ConcurrentLinkedQueue;
+
+import com.fasterxml.jackson.core.JsonGenerator;
+import com.fasterxml.jackson.core.JsonParser;
+import com.fasterxml.jackson.databind.ObjectMapper;
+import com.fasterxml.jackson.databind.json.JsonMapper;
+
+import io.github.matteobertozzi.yajbe.YajbeMapper;
+
+/**
+ * Local JSON/YAJBE conversion service, for the services written in languages without a YAJBE library.
+ * Listens on a Unix domain socket (or a loopback TCP port), the requests are length-prefixed frames:
+ * <pre>
+ * request:  | op (1 byte)     | length (4 bytes, little-endian) | payload                                |
+ * response: | status (1 byte) | length (4 bytes, little-endian) | converted document or error message    |
+ * </pre>
+ * ops: 1 = JSON to YAJBE, 2 = YAJBE to JSON. status: 0 = ok, 1 = error (utf-8 message).
+ * A connection can pipeline many requests, the responses are sent in the same order.
+ * The requests are no longer read while the responses not yet sent are above 1MiB (the client is not reading them).
+ * <p>There is one event loop (NIO selector, epoll on Linux) per core, and the connections are assigned
+ * round-robin to the loops, so a connection is always served by the same thread. The conversion is a
+ * token by token copy from the parser to the generator (no intermediate tree), and the read/write
+ * buffers of each connection are reused across the requests.
+ * <pre>
+ * java ConversionSidecar /tmp/yajbe.sock
+ * java ConversionSidecar tcp:7010
+ * </pre>
+ */
+public final class ConversionSidecar implements Closeable {
+  public static final int OP_JSON_TO_YAJBE = 1;
+  public static final int OP_YAJBE_TO_JSON = 2;
+
+  public static final int STATUS_OK = 0;
+  public static final int STATUS_ERROR = 1;
+
+  private static final int HEADER_SIZE = 5;
+  private static final int MAX_PAYLOAD_SIZE = 64 << 20;
+  private static final int MAX_PENDING_OUTPUT = 1 << 20;
+
+  private static final JsonMapper JSON = new JsonMapper();
+  private static final YajbeMapper YAJBE = new YajbeMapper();
+
+  private final ServerSocketChannel server;
+  private final EventLoop[] loops;
+  private final Thread acceptor;
+  private volatile boolean running = true;
+
+  public ConversionSidecar(final SocketAddress address, final int threads) throws IOException {
+    this.server = (address instanceof UnixDomainSocketAddress)
+      ? ServerSocketChannel.open(StandardProtocolFamily.UNIX)
+      : ServerSocketChannel.open();
+    this.server.bind(address);
+
+    this.loops = new EventLoop[threads];
+    for (int i = 0; i < threads; ++i) {
+      loops[i] = new EventLoop(i);
+      loops[i].start();
+    }
+
+    this.acceptor = new Thread(this::acceptLoop, "sidecar-acceptor");
+    this.acceptor.start();
+  }
+
+  private void acceptLoop() {
+    int next = 0;
+    while (running) {
+      try {
+        final SocketChannel channel = server.accept();
+        loops[next].add(channel);
+        next = (next + 1) % loops.length;
+      } catch (final ClosedChannelException e) {
+        return;
+      } catch (final IOException e) {
+        if (running) e.printStackTrace();
+      }
+    }
+  }
+
+  public void awaitTermination() throws InterruptedException {
+    acceptor.join();
+    for (final EventLoop loop: loops) {
+      loop.join();
+    }
+  }
+
+  @Override
+  public void close() throws IOException {
+    running = false;
+    server.close();
+    for (final EventLoop loop: loops) {
+      loop.shutdown();
+    }
+  }
+
+  // ==========================================================================================
+  //  Event Loop
+  // ==========================================================================================
+  private static final class EventLoop extends Thread {
+    private final ConcurrentLinkedQueue<SocketChannel> pending = new ConcurrentLinkedQueue<>();
+    private final Selector selector;
+    private volatile boolean running = true;
+
+    private EventLoop(final int id) throws IOException {
+      super("sidecar-loop-" + id);
+      this.selector = Selector.open();
+    }
+
+    void add(final SocketChannel channel) {
+      pending.add(channel);
+      selector.wakeup();
+    }
+
+    void shutdown() {
+      running = false;
+      selector.wakeup();
+    }
+
+    @Override
+    public void run() {
+      try {
+        while (running) {
+          selector.select();
+          registerPending();
+
+          final Iterator<SelectionKey> it = selector.selectedKeys().iterator();
+          while (it.hasNext()) {
+            final SelectionKey key = it.next();
+            it.remove();
+
+            final Connection conn = (Connection) key.attachment();
+            try {
+              if (key.isReadable()) conn.onReadable();
+              if (key.isValid() && key.isWritable()) conn.onWritable();
+            } catch (final IOException e) {
+              conn.close();
+            }
+          }
+        }
+      } catch (final IOException e) {
+        e.printStackTrace();
+      } finally {
+        for (final SelectionKey key: selector.keys()) {
+          ((Connection) key.attachment()).close();
+        }
+        try {
+          selector.close();
+        } catch (final IOException e) {
+          // no-op
+        }
+      }
+    }
+
+    private void registerPending() throws IOException {
+      SocketChannel channel;
+      while ((channel = pending.poll()) != null) {
+        channel.configureBlocking(false);
+        final SelectionKey key = channel.register(selector, SelectionKey.OP_READ);
+        key.attach(new Connection(channel, key));
+      }
+    }
+  }
+
+  // ==========================================================================================
+  //  Connection
+  // ==========================================================================================
+  private static final class Connection {
+    private final ReusableOutputStream output = new ReusableOutputStream();
+    private final SocketChannel channel;
+    private final SelectionKey key;
+    private ByteBuffer rbuf = ByteBuffer.allocate(8192).order(ByteOrder.LITTLE_ENDIAN);
+    private ByteBuffer wbuf = ByteBuffer.allocate(8192).order(ByteOrder.LITTLE_ENDIAN);
+
+    private Connection(final SocketChannel channel, final SelectionKey key) {
+      this.channel = channel;
+      this.key = key;
+    }
+
+    void onReadable() throws IOException {
+      if (channel.read(rbuf) < 0) {
+        close();
+        return;
+      }
+
+      processFrames();
+      onWritable();
+    }
+
+    private void processFrames() throws IOException {
+      // process all the complete frames, the partial one is kept for the next read.
+      // once the responses not yet sent reach MAX_PENDING_OUTPUT the frames are left in the buffer
+      rbuf.flip();
+      int frameSize = 0;
+      while (wbuf.position() < MAX_PENDING_OUTPUT && rbuf.remaining() >= HEADER_SIZE) {
+        final int op = rbuf.get(rbuf.position()) & 0xff;
+        final int length = rbuf.getInt(rbuf.position() + 1);
+        if (length < 0 || length > MAX_PAYLOAD_SIZE) {
+          throw new IOException("invalid frame length " + length);
+        }
+
+        frameSize = HEADER_SIZE + length;
+        if (rbuf.remaining() < frameSize) break;
+
+        process(op, rbuf.array(), rbuf.arrayOffset() + rbuf.position() + HEADER_SIZE, length);
+        rbuf.position(rbuf.position() + frameSize);
+        frameSize = 0;
+      }
+      rbuf.compact();
+
+      if (frameSize > rbuf.capacity()) {
+        rbuf = grow(rbuf, frameSize);
+      }
+    }
+
+    void onWritable() throws IOException {
+      wbuf.flip();
+      channel.write(wbuf);
+      wbuf.compact();
+
+      // the client is reading the responses, resume the frames left in the buffer
+      if (wbuf.position() < MAX_PENDING_OUTPUT) {
+        processFrames();
+      }
+
+      // stop reading while the client is not reading the responses
+      int ops = (wbuf.position() < MAX_PENDING_OUTPUT) ? SelectionKey.OP_READ : 0;
+      if (wbuf.position() > 0) ops |= SelectionKey.OP_WRITE;
+      key.interestOps(ops);
+    }
+
+    private void process(final int op, final byte[] buf, final int off, final int len) {
+      int status = STATUS_OK;
+      output.reset();
+      try {
+        switch (op) {
+          case OP_JSON_TO_YAJBE -> convert(JSON, YAJBE, buf, off, len);
+          case OP_YAJBE_TO_JSON -> convert(YAJBE, JSON, buf, off, len);
+          default -> throw new IOException("unsupported op " + op);
+        }
+      } catch (final Exception e) {
+        status = STATUS_ERROR;
+        output.reset();
+        output.writeBytes(String.valueOf(e.getMessage()).getBytes(StandardCharsets.UTF_8));
+      }
+
+      final int length = output.size();
+      if (wbuf.remaining() < (HEADER_SIZE + length)) {
+        wbuf = grow(wbuf, wbuf.position() + HEADER_SIZE + length);
+      }
+      wbuf.put((byte) status);
+      wbuf.putInt(length);
+      wbuf.put(output.buffer(), 0, length);
+    }
+
+    private void convert(final ObjectMapper from, final ObjectMapper to, final byte[] buf, final int off, final int len)
+        throws IOException {
+      try (JsonParser parser = from.createParser(buf, off, len);
+           JsonGenerator generator = to.createGenerator(output)) {
+        if (parser.nextToken() != null) {
+          generator.copyCurrentStructure(parser);
+        }
+      }
+    }
+
+    void close() {
+      key.cancel();
+      try {
+        channel.close();
+      } catch (final IOException e) {
+        // no-op
+      }
+    }
+
+    private static ByteBuffer grow(final ByteBuffer buf, final int minCapacity) {
+      final ByteBuffer newBuf = ByteBuffer.allocate(Math.max(buf.capacity() * 2, minCapacity)).order(ByteOrder.LITTLE_ENDIAN);
+      buf.flip();
+      newBuf.put(buf);
+      return newBuf;
+    }
+  }
+
+  private static final class ReusableOutputStream extends ByteArrayOutputStream {
+    private ReusableOutputStream() {
+      super(8192);
+    }
+
+    byte[] buffer() {
+      return buf;
+    }
+  }
+
+  public static void main(final String[] args) throws Exception {
+    final String target = (args.length > 0) ? args[0] : "/tmp/yajbe-sidecar.sock";
+    final SocketAddress address;
+    if (target.startsWith("tcp:")) {
+      address = new InetSocketAddress(InetAddress.getLoopbackAddress(), Integer.parseInt(target.substring(4)));
+    } else {
+      Files.deleteIfExists(Path.of(target));
+      address = UnixDomainSocketAddress.of(target);
+    }
+
+    final ConversionSidecar sidecar = new ConversionSidecar(address, Runtime.getRuntime().availableProcessors());
+    Runtime.getRuntime().addShutdownHook(new Thread(() -> {
+      try {
+        sidecar.close();
+      } catch (final IOException e) {
+        // no-op
+      }
+    }));
+    System.out.println("yajbe conversion sidecar listening on " + target);
+    sidecar.awaitTermination();
+  }
+}
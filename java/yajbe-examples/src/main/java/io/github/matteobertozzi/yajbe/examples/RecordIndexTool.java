@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe.examples;
+
+import java.io.BufferedOutputStream;
+import java.io.OutputStream;
+import java.nio.ByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.StandardOpenOption;
+
+import com.fasterxml.jackson.databind.json.JsonMapper;
+
+import io.github.matteobertozzi.yajbe.YajbeMapper;
+import io.github.matteobertozzi.yajbe.YajbeRecordIndex;
+import io.github.matteobertozzi.yajbe.YajbeRecordReader;
+
+/**
+ * Builds and queries the secondary index of a record file.
+ * <pre>
+ * java RecordIndexTool build events.yrec user.id events.user-id.yidx
+ * java RecordIndexTool lookup events.yrec events.user-id.yidx 1234
+ * </pre>
+ */
+public class RecordIndexTool {
+  private static final int BLOCK_SIZE = 4 << 20;
+
+  public static void main(final String[] args) throws Exception {
+    if (args.length != 4 || !(args[0].equals("build") || args[0].equals("lookup"))) {
+      System.err.println("usage: build <records> <key.path> <index>");
+      System.err.println("       lookup <records> <index> <key>");
+      System.exit(1);
+      return;
+    }
+
+    final YajbeMapper yajbe = new YajbeMapper();
+    final ByteBuffer records = map(Path.of(args[1]));
+    if (args[0].equals("build")) {
+      final long startTime = System.nanoTime();
+      final int count;
+      try (OutputStream stream = new BufferedOutputStream(Files.newOutputStream(Path.of(args[3])))) {
+        count = YajbeRecordIndex.build(yajbe, records, args[2], BLOCK_SIZE, stream);
+      }
+      System.out.printf("indexed %d records in %.3fsec%n", count, (System.nanoTime() - startTime) / 1_000_000_000.0);
+      return;
+    }
+
+    final JsonMapper json = new JsonMapper();
+    final YajbeRecordIndex index = YajbeRecordIndex.map(Path.of(args[2]));
+    final long[] offsets = index.lookup(parseKey(args[3]));
+    for (final long offset: offsets) {
+      final Object value = yajbe.readValue(YajbeRecordReader.readRecord(records, offset), Object.class);
+      System.out.println(offset + " " + json.writeValueAsString(value));
+    }
+  }
+
+  private static Object parseKey(final String key) {
+    try {
+      return Long.parseLong(key);
+    } catch (final NumberFormatException e) {
+      return key;
+    }
+  }
+
+  private static ByteBuffer map(final Path path) throws Exception {
+    try (FileChannel channel = FileChannel.open(path, StandardOpenOption.READ)) {
+      return channel.map(FileChannel.MapMode.READ_ONLY, 0, channel.size());
+    }
+  }
+}
@@ -0,0 +1,245 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe.examples.schema;
+
+import java.io.BufferedInputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.UncheckedIOException;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Map;
+import java.util.stream.Stream;
+import java.util.zip.GZIPInputStream;
+
+import com.fasterxml.jackson.core.JsonFactory;
+import com.fasterxml.jackson.core.JsonParser;
+
+import io.github.matteobertozzi.yajbe.YajbeEnumMapping;
+import io.github.matteobertozzi.yajbe.YajbeFactory;
+import io.github.matteobertozzi.yajbe.examples.schema.SchemaStats.FieldStats;
+import io.github.matteobertozzi.yajbe.examples.schema.SchemaStats.ValueType;
+import io.github.matteobertozzi.yajbe.examples.util.ExamplesUtil;
+import io.github.matteobertozzi.yajbe.examples.util.HumansTableView;
+
+/**
+ * Scans JSON/YAJBE documents and infers a schema: field paths, types, optionality,
+ * string cardinality and numeric ranges. It also recommends the codec settings
+ * (initial field names, enum LRU size and minFreq, float widths).
+ * <p>
+ * The files are scanned in parallel, each one with a streaming parser.
+ * <pre>
+ * SchemaInference [--max-field-names N] path...
+ * </pre>
+ * Supported files: .json, .json.gz, .yajbe, .yajbe.gz
+ */
+public class SchemaInference {
+  private static final JsonFactory JSON_FACTORY = new JsonFactory();
+  private static final YajbeFactory YAJBE_FACTORY = new YajbeFactory();
+
+  public static void main(final String[] args) throws Exception {
+    int maxFieldNames = 256;
+    final ArrayList<Path> roots = new ArrayList<>();
+    for (int i = 0; i < args.length; ++i) {
+      if (args[i].equals("--max-field-names")) {
+        maxFieldNames = Integer.parseInt(args[++i]);
+      } else {
+        roots.add(Path.of(args[i]));
+      }
+    }
+    if (roots.isEmpty()) roots.add(Path.of("../../test-data/"));
+
+    final List<Path> files = listFiles(roots);
+    final long startTime = System.nanoTime();
+    final SchemaStats stats = files.parallelStream()
+      .map(SchemaInference::scanFile)
+      .reduce(SchemaStats::merge)
+      .orElseGet(SchemaStats::new);
+    final long elapsed = System.nanoTime() - startTime;
+
+    System.out.println(fieldsTable(stats).addHumanView(new StringBuilder()));
+    System.out.println(recommendations(stats, maxFieldNames));
+    System.out.printf("scanned %s files, %s documents in %s%n",
+      files.size(), ExamplesUtil.humanCount(stats.documents()), ExamplesUtil.humanTimeNanos(elapsed));
+  }
+
+  private static List<Path> listFiles(final List<Path> roots) throws IOException {
+    final ArrayList<Path> files = new ArrayList<>();
+    for (final Path root: roots) {
+      try (Stream<Path> stream = Files.walk(root)) {
+        stream.filter(Files::isRegularFile).filter(SchemaInference::isSupported).forEach(files::add);
+      }
+    }
+    return files;
+  }
+
+  private static boolean isSupported(final Path path) {
+    final String name = path.getFileName().toString();
+    return name.endsWith(".json") || name.endsWith(".json.gz") || name.endsWith(".yajbe") || name.endsWith(".yajbe.gz");
+  }
+
+  public static SchemaStats scanFile(final Path path) {
+    final String name = path.getFileName().toString();
+    final SchemaStats stats = new SchemaStats();
+    try (InputStream stream = openFile(path, name.endsWith(".gz"))) {
+      final JsonFactory factory = name.contains(".yajbe") ? YAJBE_FACTORY : JSON_FACTORY;
+      try (JsonParser parser = factory.createParser(stream)) {
+        stats.scan(parser);
+      }
+    } catch (final IOException e) {
+      throw new UncheckedIOException("unable to scan " + path, e);
+    }
+    return stats;
+  }
+
+  private static InputStream openFile(final Path path, final boolean gzip) throws IOException {
+    final InputStream stream = new BufferedInputStream(Files.newInputStream(path), 1 << 16);
+    return gzip ? new GZIPInputStream(stream, 1 << 16) : stream;
+  }
+
+  // ===============================================================================================
+  //  Report
+  // ===============================================================================================
+  private static HumansTableView fieldsTable(final SchemaStats stats) {
+    final HumansTableView table = new HumansTableView();
+    table.addColumn("path", null);
+    table.addColumn("types", null);
+    table.addColumn("presence", null);
+    table.addColumn("cardinality", null);
+    table.addColumn("range", null);
+
+    final Map<String, FieldStats> fields = stats.fields();
+    for (final Map.Entry<String, FieldStats> entry: fields.entrySet()) {
+      final FieldStats field = entry.getValue();
+      table.addRow(entry.getKey(), types(field), presence(fields, field),
+        field.count(ValueType.STRING) > 0 ? field.values().cardinality() : "-", range(field));
+    }
+    return table;
+  }
+
+  private static String types(final FieldStats field) {
+    final StringBuilder builder = new StringBuilder();
+    for (final ValueType type: ValueType.values()) {
+      final long count = field.count(type);
+      if (count == 0) continue;
+      if (builder.length() > 0) builder.append(", ");
+      builder.append(type.name().toLowerCase()).append(':').append(ExamplesUtil.humanCount(count));
+    }
+    return builder.toString();
+  }
+
+  /**
+   * The fields of the objects inside an array have the array items as parent (e.g. "$[]"),
+   * so the presence is computed over the number of objects in the array.
+   */
+  static String presence(final Map<String, FieldStats> fields, final FieldStats field) {
+    if (field.parentPath() == null) return "-";
+    final FieldStats parent = fields.get(field.parentPath());
+    final long objects = parent != null ? parent.count(ValueType.OBJECT) : 0;
+    if (objects == 0 || field.count() >= objects) return "required";
+    return String.format("optional %.1f%%", 100.0 * field.count() / objects);
+  }
+
+  private static String range(final FieldStats field) {
+    final ArrayList<String> ranges = new ArrayList<>();
+    if (field.count(ValueType.INT) > 0) {
+      ranges.add(field.hasBigInt() ? "int:big" : ("int:[" + field.minInt() + ", " + field.maxInt() + "]"));
+    }
+    if (field.count(ValueType.FLOAT) > 0) {
+      ranges.add("float:[" + field.minFloat() + ", " + field.maxFloat() + "]" + (field.float64Count() == 0 ? " f32" : " f64"));
+    }
+    if (field.count(ValueType.STRING) > 0 || field.count(ValueType.BYTES) > 0) {
+      ranges.add("len:[" + field.minLength() + ", " + field.maxLength() + "]");
+    }
+    if (field.count(ValueType.ARRAY) > 0) {
+      ranges.add("items:[" + field.minItems() + ", " + field.maxItems() + "]");
+    }
+    return String.join(" ", ranges);
+  }
+
+  // ===============================================================================================
+  //  Recommendations
+  // ===============================================================================================
+  private static String recommendations(final SchemaStats stats, final int maxFieldNames) {
+    final StringBuilder report = new StringBuilder();
+
+    // initial field names: the most frequent names that are repeated
+    final List<String> fieldNames = stats.fieldNames().entrySet().stream()
+      .filter(e -> e.getValue() > 1)
+      .sorted((a, b) -> Long.compare(b.getValue(), a.getValue()))
+      .limit(maxFieldNames)
+      .map(Map.Entry::getKey)
+      .toList();
+    report.append("initial field names (").append(fieldNames.size()).append("): ");
+    report.append(fieldNames.stream().map(SchemaInference::quote).toList()).append('\n');
+
+    // enum mapping: strings long enough to be mapped, that are repeated
+    final Map<String, Long> values = stats.stringValues().counts();
+    final long[] repeated = values.entrySet().stream()
+      .filter(e -> e.getKey().length() >= YajbeEnumMapping.MIN_ENUM_STRING_LENGTH && e.getValue() > 1)
+      .mapToLong(Map.Entry::getValue)
+      .sorted()
+      .toArray();
+    if (repeated.length == 0) {
+      report.append("enum mapping: not useful, no repeated string values\n");
+    } else {
+      final int lruSize = enumLruSize(values.size(), repeated.length, stats.stringValues().isOverflow());
+      final int minFreq = enumMinFreq(repeated, values.size(), lruSize);
+      long repeatedCount = 0;
+      for (final long count: repeated) repeatedCount += count;
+      report.append(String.format("enum mapping: %s repeated values (%.1f%% of %s strings) -> new YajbeEnumLruMappingConfig(%d, %d)%n",
+        ExamplesUtil.humanCount(repeated.length), 100.0 * repeatedCount / stats.stringCount(),
+        ExamplesUtil.humanCount(stats.stringCount()), lruSize, minFreq));
+    }
+
+    // float widths
+    for (final Map.Entry<String, FieldStats> entry: stats.fields().entrySet()) {
+      final FieldStats field = entry.getValue();
+      if (field.count(ValueType.FLOAT) == 0) continue;
+      report.append("float width ").append(entry.getKey()).append(": ");
+      report.append(field.float64Count() == 0 ? "float32 (all values are exact)" : "float64").append('\n');
+    }
+    return report.toString();
+  }
+
+  /**
+   * The LRU should be large enough to keep all the repeated values (x2 to leave room for the non repeated ones).
+   * The size is encoded as 1 << (5 + n) with n in 0-15, and the enum index is limited to 16bit.
+   */
+  static int enumLruSize(final int distinctValues, final int repeatedValues, final boolean overflow) {
+    final int target = overflow ? YajbeEnumMapping.MAX_INDEX_LENGTH : Math.min(distinctValues, repeatedValues * 2);
+    final int size = Integer.highestOneBit(Math.max(31, target - 1)) << 1;
+    return Math.min(size, 1 << 16);
+  }
+
+  /**
+   * If all the distinct values fit in the LRU, there is no eviction and each repeated value can be mapped early.
+   * Otherwise use a fraction of the median frequency, so that only the hot values are mapped.
+   */
+  static int enumMinFreq(final long[] sortedRepeatedFreqs, final int distinctValues, final int lruSize) {
+    if (distinctValues <= lruSize) return 1;
+    final long median = sortedRepeatedFreqs[sortedRepeatedFreqs.length / 2];
+    return (int) Math.max(2, Math.min(256, median / 4));
+  }
+
+  private static String quote(final String text) {
+    return '"' + text.replace("\\", "\\\\").replace("\"", "\\\"") + '"';
+  }
+}
@@ -0,0 +1,279 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe.examples.schema;
+
+import java.io.IOException;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.TreeMap;
+
+import com.fasterxml.jackson.core.JsonParser;
+import com.fasterxml.jackson.core.JsonToken;
+
+/**
+ * Statistics collected while scanning the documents with a streaming parser.
+ * Each file is scanned into its own instance, and the results are merged.
+ */
+public final class SchemaStats {
+  /** max number of distinct string values tracked globally and per field */
+  static final int MAX_TRACKED_VALUES = 1 << 16;
+  static final int MAX_TRACKED_FIELD_VALUES = 1 << 12;
+
+  public enum ValueType { NULL, BOOL, INT, FLOAT, STRING, BYTES, OBJECT, ARRAY }
+
+  private final Map<String, FieldStats> fields = new HashMap<>();
+  private final Map<String, Long> fieldNames = new HashMap<>();
+  private final BoundedCounter stringValues = new BoundedCounter(MAX_TRACKED_VALUES);
+  private long stringCount;
+  private long documents;
+
+  public Map<String, FieldStats> fields() { return new TreeMap<>(fields); }
+  public Map<String, Long> fieldNames() { return fieldNames; }
+  public BoundedCounter stringValues() { return stringValues; }
+  public long stringCount() { return stringCount; }
+  public long documents() { return documents; }
+
+  // ===============================================================================================
+  //  Scan
+  // ===============================================================================================
+  private static final class Frame {
+    private final HashMap<String, String> childPaths = new HashMap<>();
+    private final FieldStats stats;
+    private final String path;
+    private final boolean isArray;
+    private String fieldPath;
+    private long items;
+
+    private Frame(final String path, final FieldStats stats, final boolean isArray) {
+      this.path = path;
+      this.stats = stats;
+      this.isArray = isArray;
+    }
+
+    private String valuePath() {
+      return isArray ? path : fieldPath;
+    }
+  }
+
+  /**
+   * Scan all the values returned by the parser (e.g. a single document or a stream of documents).
+   * Only the current path is kept in memory, so the input can be larger than the heap.
+   */
+  public void scan(final JsonParser parser) throws IOException {
+    final Frame[] stack = new Frame[256];
+    int depth = 0;
+
+    JsonToken token;
+    while ((token = parser.nextToken()) != null) {
+      final Frame top = depth > 0 ? stack[depth - 1] : null;
+      if (top == null) documents++;
+      switch (token) {
+        case START_OBJECT, START_ARRAY -> {
+          final boolean isArray = token == JsonToken.START_ARRAY;
+          final String path = (top == null) ? "$" : top.valuePath();
+          final FieldStats stats = addValue(top, path, isArray ? ValueType.ARRAY : ValueType.OBJECT);
+          if (depth == stack.length) throw new IOException("document too deep: " + path);
+          stack[depth++] = new Frame(isArray ? path + "[]" : path, stats, isArray);
+        }
+        case END_OBJECT -> depth--;
+        case END_ARRAY -> {
+          final Frame frame = stack[--depth];
+          frame.stats.addArrayLength(frame.items);
+        }
+        case FIELD_NAME -> {
+          final String name = parser.currentName();
+          fieldNames.merge(name, 1L, Long::sum);
+          top.fieldPath = top.childPaths.computeIfAbsent(name, k -> top.path + "." + k);
+        }
+        case VALUE_NULL -> addValue(top, top == null ? "$" : top.valuePath(), ValueType.NULL);
+        case VALUE_TRUE, VALUE_FALSE -> addValue(top, top == null ? "$" : top.valuePath(), ValueType.BOOL);
+        case VALUE_NUMBER_INT -> {
+          final FieldStats stats = addValue(top, top == null ? "$" : top.valuePath(), ValueType.INT);
+          if (parser.getNumberType() == JsonParser.NumberType.BIG_INTEGER) {
+            stats.bigInt = true;
+          } else {
+            stats.addInt(parser.getLongValue());
+          }
+        }
+        case VALUE_NUMBER_FLOAT -> {
+          final FieldStats stats = addValue(top, top == null ? "$" : top.valuePath(), ValueType.FLOAT);
+          stats.addFloat(parser.getDoubleValue());
+        }
+        case VALUE_STRING -> {
+          final FieldStats stats = addValue(top, top == null ? "$" : top.valuePath(), ValueType.STRING);
+          final String text = parser.getText();
+          stats.addString(text);
+          stringValues.add(text, 1);
+          stringCount++;
+        }
+        case VALUE_EMBEDDED_OBJECT -> {
+          final FieldStats stats = addValue(top, top == null ? "$" : top.valuePath(), ValueType.BYTES);
+          stats.addLength(parser.getBinaryValue().length);
+        }
+        default -> throw new IOException("unexpected token " + token);
+      }
+    }
+  }
+
+  private FieldStats addValue(final Frame parent, final String path, final ValueType type) {
+    final FieldStats stats = fields.computeIfAbsent(path, k -> new FieldStats(parent != null ? parent.path : null));
+    stats.types[type.ordinal()]++;
+    if (parent != null) parent.items++;
+    return stats;
+  }
+
+  public SchemaStats merge(final SchemaStats other) {
+    for (final Map.Entry<String, FieldStats> entry: other.fields.entrySet()) {
+      fields.merge(entry.getKey(), entry.getValue(), FieldStats::merge);
+    }
+    for (final Map.Entry<String, Long> entry: other.fieldNames.entrySet()) {
+      fieldNames.merge(entry.getKey(), entry.getValue(), Long::sum);
+    }
+    stringValues.merge(other.stringValues);
+    stringCount += other.stringCount;
+    documents += other.documents;
+    return this;
+  }
+
+  // ===============================================================================================
+  //  Field Stats
+  // ===============================================================================================
+  public static final class FieldStats {
+    private final long[] types = new long[ValueType.values().length];
+    private final BoundedCounter values = new BoundedCounter(MAX_TRACKED_FIELD_VALUES);
+    private final String parentPath;
+    private long minInt = Long.MAX_VALUE;
+    private long maxInt = Long.MIN_VALUE;
+    private boolean bigInt;
+    private double minFloat = Double.POSITIVE_INFINITY;
+    private double maxFloat = Double.NEGATIVE_INFINITY;
+    private long float64Count;
+    private long minLength = Long.MAX_VALUE;
+    private long maxLength = Long.MIN_VALUE;
+    private long minItems = Long.MAX_VALUE;
+    private long maxItems = Long.MIN_VALUE;
+
+    private FieldStats(final String parentPath) {
+      this.parentPath = parentPath;
+    }
+
+    public String parentPath() { return parentPath; }
+    public long count(final ValueType type) { return types[type.ordinal()]; }
+    public long count() {
+      long total = 0;
+      for (final long v: types) total += v;
+      return total;
+    }
+
+    public BoundedCounter values() { return values; }
+    public boolean hasBigInt() { return bigInt; }
+    public long minInt() { return minInt; }
+    public long maxInt() { return maxInt; }
+    public double minFloat() { return minFloat; }
+    public double maxFloat() { return maxFloat; }
+    public long float64Count() { return float64Count; }
+    public long minLength() { return minLength; }
+    public long maxLength() { return maxLength; }
+    public long minItems() { return minItems; }
+    public long maxItems() { return maxItems; }
+
+    private void addInt(final long v) {
+      minInt = Math.min(minInt, v);
+      maxInt = Math.max(maxInt, v);
+    }
+
+    private void addFloat(final double v) {
+      minFloat = Math.min(minFloat, v);
+      maxFloat = Math.max(maxFloat, v);
+      if (!Double.isNaN(v) && (double) ((float) v) != v) float64Count++;
+    }
+
+    private void addString(final String text) {
+      addLength(text.length());
+      values.add(text, 1);
+    }
+
+    private void addLength(final long length) {
+      minLength = Math.min(minLength, length);
+      maxLength = Math.max(maxLength, length);
+    }
+
+    private void addArrayLength(final long items) {
+      minItems = Math.min(minItems, items);
+      maxItems = Math.max(maxItems, items);
+    }
+
+    private FieldStats merge(final FieldStats other) {
+      for (int i = 0; i < types.length; ++i) types[i] += other.types[i];
+      values.merge(other.values);
+      minInt = Math.min(minInt, other.minInt);
+      maxInt = Math.max(maxInt, other.maxInt);
+      bigInt |= other.bigInt;
+      minFloat = Math.min(minFloat, other.minFloat);
+      maxFloat = Math.max(maxFloat, other.maxFloat);
+      float64Count += other.float64Count;
+      minLength = Math.min(minLength, other.minLength);
+      maxLength = Math.max(maxLength, other.maxLength);
+      minItems = Math.min(minItems, other.minItems);
+      maxItems = Math.max(maxItems, other.maxItems);
+      return this;
+    }
+  }
+
+  // ===============================================================================================
+  //  Bounded Counter
+  // ===============================================================================================
+  /**
+   * Counts the occurrences of the values, up to maxValues distinct values.
+   * Once full, new values are no longer tracked and the cardinality is reported as a lower bound.
+   */
+  public static final class BoundedCounter {
+    private final HashMap<String, Long> counts = new HashMap<>();
+    private final int maxValues;
+    private boolean overflow;
+
+    private BoundedCounter(final int maxValues) {
+      this.maxValues = maxValues;
+    }
+
+    public Map<String, Long> counts() { return counts; }
+    public boolean isOverflow() { return overflow; }
+
+    public String cardinality() {
+      return overflow ? (">" + counts.size()) : String.valueOf(counts.size());
+    }
+
+    private void add(final String value, final long count) {
+      final Long current = counts.get(value);
+      if (current != null) {
+        counts.put(value, current + count);
+      } else if (counts.size() < maxValues) {
+        counts.put(value, count);
+      } else {
+        overflow = true;
+      }
+    }
+
+    private void merge(final BoundedCounter other) {
+      overflow |= other.overflow;
+      for (final Map.Entry<String, Long> entry: other.counts.entrySet()) {
+        add(entry.getKey(), entry.getValue());
+      }
+    }
+  }
+}
@@ -0,0 +1,47 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package io.github.matteobertozzi.yajbe.examples.schema;
+
+import static org.junit.jupiter.api.Assertions.assertEquals;
+
+import java.io.IOException;
+import java.util.Map;
+
+import org.junit.jupiter.api.Test;
+
+import com.fasterxml.jackson.core.JsonFactory;
+import com.fasterxml.jackson.core.JsonParser;
+
+import io.github.matteobertozzi.yajbe.examples.schema.SchemaStats.FieldStats;
+import io.github.matteobertozzi.yajbe.examples.schema.SchemaStats.ValueType;
+
+public class TestSchemaInference {
+  @Test
+  public void testArrayOfRecordsPresence() throws IOException {
+    final SchemaStats stats = new SchemaStats();
+    try (JsonParser parser = new JsonFactory().createParser("[{\"a\":1},{\"a\":2,\"b\":3}]")) {
+      stats.scan(parser);
+    }
+
+    final Map<String, FieldStats> fields = stats.fields();
+    assertEquals(2, fields.get("$[]").count(ValueType.OBJECT));
+    assertEquals("required", SchemaInference.presence(fields, fields.get("$[].a")));
+    assertEquals(String.format("optional %.1f%%", 50.0), SchemaInference.presence(fields, fields.get("$[].b")));
+    assertEquals("-", SchemaInference.presence(fields, fields.get("$")));
+  }
+}
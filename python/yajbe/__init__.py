@@ -14,6 +14,6 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
-from .encoder import encode_to_stream, encode_as_bytes
-from .decoder import decode_stream, decode_bytes
+from .encoder import encode_to_stream, encode_as_bytes, YajbeBlobWriter
+from .decoder import decode_stream, decode_bytes, YajbeDocument
 from .freq import YajbeEnumLruConfig
@@ -27,10 +27,27 @@ class FieldNameReader:
         if initial_field_names:
             for name in initial_field_names[:65819]:
                 self._indexed_names.append(name.encode('utf-8'))
+        self._initial_count = len(self._indexed_names)
 
-    def decode_string(self) -> str:
+    def reset(self) -> None:
+        # back to the initial state, only the initial field names indexed
+        del self._indexed_names[self._initial_count:]
+        self._last_key = b''
+
+    def scope(self) -> tuple[int, bytes]:
+        # sized container: the names indexed inside are dropped at the end of it
+        return len(self._indexed_names), self._last_key
+
+    def close_scope(self, scope: tuple[int, bytes]) -> None:
+        del self._indexed_names[scope[0]:]
+        self._last_key = scope[1]
+
+    def decode_string(self) -> str | int:
         head = self._decoder._read_byte()
         match (head >> 5) & 0b111:
+            case 0b010 | 0b011:
+                # int keys are not indexed, and don't change the last key used by prefix/suffix
+                return self._decoder._decode_int(head)
             case 0b100:
                 return self._read_full_field_name(head)
             case 0b101:
@@ -42,7 +59,7 @@ class FieldNameReader:
 
     def _read_full_field_name(self, head: int) -> str:
         length = self._read_length(head)
-        utf8 = self._decoder._read_bytes(length)
+        utf8 = bytes(self._decoder._read_bytes(length))
         return self._add_to_index(utf8)
 
     def _read_indexed_field_name(self, head: int) -> str:
@@ -83,11 +100,43 @@ class FieldNameReader:
         return utf8.decode('utf-8')
 
 
+class YajbeDocument:
+    """
+    An independently encoded document (own field names and enum state), embedded as a length-prefixed value.
+    The decoder skips it without decoding it, the value is decoded on access.
+    """
+    __slots__ = ('data', '_value', '_decoded')
+
+    def __init__(self, data) -> None:
+        self.data = data
+        self._value = None
+        self._decoded = False
+
+    def decode(self, initial_field_names: list[str] = None):
+        if not self._decoded:
+            self._value = decode_bytes(self.data, initial_field_names)
+            self._decoded = True
+        return self._value
+
+    def __eq__(self, other) -> bool:
+        return isinstance(other, YajbeDocument) and self.data == other.data
+
+    def __hash__(self) -> int:
+        return hash(bytes(self.data))
+
+    def __repr__(self) -> str:
+        return 'YajbeDocument(%d bytes)' % len(self.data)
+
+
 class YajbeDecoder:
-    def __init__(self, stream: io.BufferedReader, initial_field_names: list[str] = None) -> None:
+    def __init__(self, stream: io.BufferedReader, initial_field_names: list[str] = None, numpy_arrays: bool = False, blobs = None) -> None:
         self._stream = stream
         self._field_name_reader = FieldNameReader(self, initial_field_names)
         self._enum_mapping = None
+        self._sized_depth = 0
+        self._numpy = _import_numpy() if numpy_arrays else None
+        # blob region (e.g. an mmap), the blob references are returned as memoryview slices of it
+        self._blobs = memoryview(blobs).cast('B') if blobs is not None else None
 
     def decode_item(self):
         while True:
@@ -102,6 +151,19 @@ class YajbeDecoder:
                 return self._decode_object(head)
             if (head & 0b0010_0000) == 0b0010_0000:
                 return self._decode_array(head)
+            if (head & 0b0001_0000) == 0b0001_0000:
+                match head:
+                    case 0b00010000: return b''.join(self._read_chunks())
+                    case 0b00010001: return str(b''.join(self._read_chunks()), 'utf-8')
+                    case 0b00010010: return self._decode_blob_ref()
+                    case 0b00010011: return YajbeDocument(self._decode_bytes(self._read_byte()))
+                    case 0b00010100:
+                        # reset: field names and enum mapping back to the initial state
+                        self._field_name_reader.reset()
+                        self._enum_mapping = None
+                        continue
+                    case 0b00010101: return self._decode_sized_container()
+                    case other: raise Exception('unsupported item head ' + bin(other))
             if (head & 0b00001_000) == 0b00001_000:
                 match head:
                     # enum config
@@ -131,10 +193,58 @@ class YajbeDecoder:
         length = self._read_length(w, 59)
         return self._read_bytes(length)
 
+    def decode_chunks(self):
+        """
+        Streaming read of the next bytes/string item, the chunks are yielded as they are read.
+        A bytes/string item with a known length is yielded as a single chunk.
+        """
+        head = self._read_byte()
+        if head == 0b00010000 or head == 0b00010001:
+            yield from self._read_chunks()
+        elif (head & 0b10_000000) == 0b10_000000:
+            yield self._decode_bytes(head)
+        else:
+            raise Exception('expected bytes or string, got head ' + bin(head))
+
+    def _read_chunks(self):
+        while True:
+            head = self._read_byte()
+            if head == 0b00000001:
+                return
+            if (head & 0b11_000000) != 0b10_000000:
+                raise Exception('unexpected chunk head ' + bin(head))
+            yield self._decode_bytes(head)
+
+    def _decode_blob_ref(self) -> memoryview:
+        offset = self._decode_int(self._read_byte())
+        length = self._decode_int(self._read_byte())
+        if self._blobs is None:
+            raise Exception('found a blob reference, but no blob region was specified')
+        if offset < 0 or length < 0 or (offset + length) > len(self._blobs):
+            raise Exception('invalid blob reference offset %d length %d, region size %d' % (offset, length, len(self._blobs)))
+        return self._blobs[offset:offset + length]
+
+    def _decode_sized_container(self):
+        # int byte length (used only to skip the container), then the array/map.
+        # the field names indexed inside are dropped at the end, and the enum mapping is not used inside
+        self._decode_int(self._read_byte())
+        head = self._read_byte()
+        scope = self._field_name_reader.scope()
+        self._sized_depth += 1
+        if (head & 0b0011_0000) == 0b0011_0000:
+            result = self._decode_object(head)
+        elif (head & 0b0010_0000) == 0b0010_0000:
+            result = self._decode_array(head)
+        else:
+            raise Exception('expected array or map after the sized head, got ' + bin(head))
+        self._sized_depth -= 1
+        self._field_name_reader.close_scope(scope)
+        return result
+
     def _decode_string(self, head: int) -> str:
         utf8 = self._decode_bytes(head)
-        text = utf8.decode('utf-8')
-        if self._enum_mapping is not None:
+        text = str(utf8, 'utf-8')
+        if self._enum_mapping is not None and self._sized_depth == 0:
             self._enum_mapping.add(text)
         return text
 
@@ -189,11 +299,20 @@ class YajbeDecoder:
             return result
 
         length = self._read_length(w, 10)
+        if self._numpy is not None:
+            return self._decode_numpy_array(length)
+
         result = []
         for _ in range(length):
             result.append(self.decode_item())
         return result
 
+    def _decode_numpy_array(self, length: int):
+        result = []
+        for _ in range(length):
+            result.append(self.decode_item())
+        return _as_numpy_array(self._numpy, result)
+
     def _decode_object(self, head: int) -> dict:
         w = head & 0b1111
         if w == 0b1111:
@@ -244,14 +363,80 @@ class YajbeDecoder:
         return value
 
 
-def decode_stream(stream: io.BufferedReader, initial_field_names: list[str] = None):
+class YajbeBufferDecoder(YajbeDecoder):
+    """
+    Decoder over an in-memory buffer (anything exposing the buffer protocol).
+    bytes values are returned as memoryview slices of the input, no copy is made.
+    """
+    def __init__(self, data, initial_field_names: list[str] = None, numpy_arrays: bool = False, blobs = None) -> None:
+        super().__init__(None, initial_field_names, numpy_arrays, blobs)
+        self._buf = memoryview(data).cast('B')
+        self._offset = 0
+
+    def _decode_numpy_array(self, length: int):
+        # fast path: an array of float32/float64 is a fixed-stride sequence of (head, value)
+        np = self._numpy
+        if length > 0 and self._offset < len(self._buf):
+            match self._buf[self._offset]:
+                case 0b00000_101: dtype = np.dtype([('h', 'u1'), ('v', '<f4')])
+                case 0b00000_110: dtype = np.dtype([('h', 'u1'), ('v', '<f8')])
+                case _: dtype = None
+            if dtype is not None and (self._offset + length * dtype.itemsize) <= len(self._buf):
+                items = np.frombuffer(self._buf, dtype=dtype, count=length, offset=self._offset)
+                if (items['h'] == self._buf[self._offset]).all():
+                    self._offset += length * dtype.itemsize
+                    return np.ascontiguousarray(items['v'])
+        return super()._decode_numpy_array(length)
+
+    def _read_has_more(self) -> bool:
+        if self._offset >= len(self._buf):
+            raise EOFError('peek at offset %d' % self._offset)
+        if self._buf[self._offset] != 0b00000001:
+            return True
+        self._offset += 1
+        return False
+
+    def _read_byte(self) -> int:
+        if self._offset >= len(self._buf):
+            raise EOFError()
+        v = self._buf[self._offset]
+        self._offset += 1
+        return v
+
+    def _read_bytes(self, length: int) -> memoryview:
+        end = self._offset + length
+        if end > len(self._buf):
+            raise EOFError()
+        data = self._buf[self._offset:end]
+        self._offset = end
+        return data
+
+
+def _import_numpy():
+    import numpy
+    return numpy
+
+
+def _as_numpy_array(np, items: list):
+    # only homogeneous int or float arrays are converted, anything else stays a list
+    if all(type(v) is int for v in items):
+        try:
+            return np.array(items, dtype=np.int64)
+        except OverflowError:
+            return items
+    if all(type(v) is float for v in items):
+        return np.array(items, dtype=np.float64)
+    return items
+
+
+def decode_stream(stream: io.BufferedReader, initial_field_names: list[str] = None, numpy_arrays: bool = False, blobs = None):
     if not isinstance(stream, io.BufferedReader):
         raise Exception('expected a buffered stream')
 
-    decoder = YajbeDecoder(stream, initial_field_names)
+    decoder = YajbeDecoder(stream, initial_field_names, numpy_arrays, blobs)
     return decoder.decode_item()
 
 
-def decode_bytes(data: bytes, initial_field_names: list[str] = None):
-    with io.BufferedReader(io.BytesIO(data)) as stream:
-        return decode_stream(stream, initial_field_names)
+def decode_bytes(data: bytes, initial_field_names: list[str] = None, numpy_arrays: bool = False, blobs = None):
+    decoder = YajbeBufferDecoder(data, initial_field_names, numpy_arrays, blobs)
+    return decoder.decode_item()
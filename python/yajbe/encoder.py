@@ -17,8 +17,11 @@
 import struct
 import io
 
+from decoder import YajbeDocument
 from freq import EnumLruMapping, YajbeEncoderEnumConfig, YajbeEnumLruConfig
 
+CHUNK_SIZE = 64 << 10
+
 def int_bytes_width(v: int) -> int:
     return (v.bit_length() + 7) // 8 if v != 0 else 1
 
@@ -116,11 +119,44 @@ class FieldNameWriter:
         return min_len
 
 
+class YajbeBlobWriter:
+    """
+    Moves the bytes values above the threshold out of the document, into a sidecar region.
+    With a sidecar stream the blobs are appended to it while the document is encoded,
+    otherwise they are kept by reference and written with write_to() after the document.
+    The offsets are relative to the start of the blob region.
+    """
+    def __init__(self, threshold: int, sidecar: io.BufferedIOBase = None) -> None:
+        if threshold <= 0:
+            raise ValueError('expected a threshold greater than zero, got %d' % threshold)
+        self.threshold = threshold
+        self.size = 0
+        self._sidecar = sidecar
+        self._pending = []
+
+    def append(self, data: memoryview) -> int:
+        offset = self.size
+        if self._sidecar is not None:
+            self._sidecar.write(data)
+        else:
+            self._pending.append(data)
+        self.size += data.nbytes
+        return offset
+
+    def write_to(self, stream: io.BufferedIOBase) -> None:
+        for data in self._pending:
+            stream.write(data)
+        self._pending.clear()
+        self.size = 0
+
+
 class YajbeEncoder:
-    def __init__(self, stream: io.BufferedIOBase, initial_field_names: list[str] = None, enum_config: YajbeEncoderEnumConfig = None) -> None:
+    def __init__(self, stream: io.BufferedIOBase, initial_field_names: list[str] = None, enum_config: YajbeEncoderEnumConfig = None,
+                 blob_writer: YajbeBlobWriter = None) -> None:
         self._stream = stream
         self._field_name_writer = FieldNameWriter(self, initial_field_names)
         self._enum_config = enum_config
+        self._blob_writer = blob_writer
         self._enum_mapping = None
         self._types_map = {
             bool: self.encode_bool,
@@ -128,11 +164,13 @@ class YajbeEncoder:
             float: self.encode_float,
             bytes: self.encode_bytes,
             bytearray: self.encode_bytes,
+            memoryview: self.encode_bytes,
             str: self.encode_string,
             list: self.encode_array,
             tuple: self.encode_array,
             set: self.encode_array,
             dict: self.encode_object,
+            YajbeDocument: self.encode_document,
         }
 
     def encode_item(self, item):
@@ -141,9 +179,24 @@ class YajbeEncoder:
 
         item_type = type(item)
         encoder = self._types_map.get(item_type)
-        if encoder is None:
-            raise Exception('unsupported type %s: %s' % (item_type, item))
-        encoder(item)
+        if encoder is not None:
+            encoder(item)
+        elif hasattr(item, 'dtype') and hasattr(item, 'ndim'):
+            if item.ndim == 0:
+                # numpy scalars (e.g. numpy.float32(0.5)) are encoded as the python value
+                self.encode_item(item.item())
+            else:
+                self.encode_numpy_array(item)
+        elif isinstance(item, io.TextIOBase):
+            self.encode_chunked_string(iter(lambda: item.read(CHUNK_SIZE >> 2), ''))
+        elif isinstance(item, io.IOBase):
+            self.encode_chunked_bytes(iter(lambda: item.read(CHUNK_SIZE), b''))
+        else:
+            try:
+                data = memoryview(item)
+            except TypeError:
+                raise Exception('unsupported type %s: %s' % (item_type, item))
+            self.encode_bytes(data)
 
     def encode_null(self):
         self._write_byte(0)
@@ -218,14 +271,72 @@ class YajbeEncoder:
                 return
 
     def encode_bytes(self, value: bytes) -> None:
-        self._write_length(0b10_000000, 59, len(value))
-        self._stream.write(value)
+        # anything exposing the buffer protocol is written as-is, without a copy
+        data = memoryview(value)
+        if not data.contiguous:
+            data = memoryview(data.tobytes())
+        if self._blob_writer is not None and data.nbytes >= self._blob_writer.threshold:
+            # blob reference: head, int offset, int length
+            self._write_byte(0b00010010)
+            self.encode_int(self._blob_writer.append(data))
+            self.encode_int(data.nbytes)
+            return
+        self._write_bytes_item(data)
+
+    def _write_bytes_item(self, data) -> None:
+        self._write_length(0b10_000000, 59, memoryview(data).nbytes)
+        self._stream.write(data)
+
+    def encode_document(self, doc: YajbeDocument) -> None:
+        # the document is already encoded, written as-is: head, bytes
+        self._write_byte(0b00010011)
+        self._write_bytes_item(doc.data)
+
+    def encode_chunked_bytes(self, chunks) -> None:
+        # the length is not known upfront: head, bytes chunks..., EOF
+        self._write_byte(0b00010000)
+        for chunk in chunks:
+            if len(chunk) > 0:
+                self._write_bytes_item(chunk)
+        self._write_byte(0b00000001)
+
+    def encode_chunked_string(self, chunks) -> None:
+        # same as chunked bytes, the chunks are the utf-8 of each text chunk
+        self._write_byte(0b00010001)
+        for chunk in chunks:
+            if len(chunk) > 0:
+                self._write_bytes_item(chunk.encode('utf-8'))
+        self._write_byte(0b00000001)
+
+    def encode_numpy_array(self, array) -> None:
+        if array.ndim != 1:
+            self.encode_array(array.tolist())
+            return
+
+        match array.dtype.kind, array.dtype.itemsize:
+            case 'f', 4: head, vtype = 0b00000_101, '<f4'
+            case 'f', 8: head, vtype = 0b00000_110, '<f8'
+            case _:
+                self.encode_array(array.tolist())
+                return
+
+        # float arrays are written in one shot as a packed sequence of (head, value)
+        import numpy
+        items = numpy.empty(len(array), dtype=numpy.dtype([('h', 'u1'), ('v', vtype)]))
+        items['h'] = head
+        items['v'] = array
+        self._write_length(0b0010_0000, 10, len(array))
+        self._stream.write(memoryview(items).cast('B'))
 
     def encode_object(self, obj: dict) -> None:
         keys = obj.keys()
         self._write_length(0b0011_0000, 10, len(keys))
         for key in keys:
-            self._field_name_writer.encode_string(key)
+            if isinstance(key, int) and not isinstance(key, bool):
+                # int keys are written as int items, not indexed
+                self.encode_int(key)
+            else:
+                self._field_name_writer.encode_string(key)
             self.encode_item(obj[key])
 
     def encode_array(self, array: list) -> None:
@@ -255,12 +366,14 @@ class YajbeEncoder:
         self._stream.write(buf)
 
 
-def encode_to_stream(stream: io.BufferedIOBase, value, initial_field_names: list[str] = None, enum_config: YajbeEncoderEnumConfig = None) -> None:
-    decoder = YajbeEncoder(stream, initial_field_names, enum_config)
+def encode_to_stream(stream: io.BufferedIOBase, value, initial_field_names: list[str] = None, enum_config: YajbeEncoderEnumConfig = None,
+                     blob_writer: YajbeBlobWriter = None) -> None:
+    decoder = YajbeEncoder(stream, initial_field_names, enum_config, blob_writer)
     decoder.encode_item(value)
 
 
-def encode_as_bytes(value, initial_field_names: list[str] = None, enum_config: YajbeEncoderEnumConfig = None) -> bytes:
+def encode_as_bytes(value, initial_field_names: list[str] = None, enum_config: YajbeEncoderEnumConfig = None,
+                    blob_writer: YajbeBlobWriter = None) -> bytes:
     with io.BytesIO() as stream:
-        encode_to_stream(stream, value, initial_field_names, enum_config)
+        encode_to_stream(stream, value, initial_field_names, enum_config, blob_writer)
         return stream.getvalue()
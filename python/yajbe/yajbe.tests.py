@@ -14,10 +14,17 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import array
+import io
 import unittest
 
-from encoder import encode_as_bytes
-from decoder import decode_bytes
+from encoder import YajbeBlobWriter, encode_as_bytes, encode_to_stream
+from decoder import YajbeBufferDecoder, YajbeDocument, decode_bytes, decode_stream
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
 
 
 class TestYajbe(unittest.TestCase):
@@ -146,6 +153,140 @@ class TestYajbe(unittest.TestCase):
         self.assertEncodeDecode(bytearray(0xffffff), "bec4ffff" + "00" * 0xffffff)
         # self.assertEncodeDecode(bytearray(0x1000000), "bec5ffff" + "00" * (0x1000000))
 
+    def test_bytes_zero_copy(self):
+        enc = encode_as_bytes({'a': b'hello', 'b': [b'world']})
+        dec = decode_bytes(enc)
+        self.assertIsInstance(dec['a'], memoryview)
+        self.assertIs(dec['a'].obj, enc)
+        self.assertEqual(b'hello', dec['a'])
+        self.assertEqual(b'world', dec['b'][0])
+
+        # stream decode still returns copies
+        with io.BufferedReader(io.BytesIO(enc)) as stream:
+            self.assertEqual({'a': b'hello', 'b': [b'world']}, decode_stream(stream))
+
+    def test_bytes_buffer_protocol(self):
+        self.assertEncode(memoryview(b'abc'), "83616263")
+        self.assertEncode(memoryview(b'xabcx')[1:4], "83616263")
+        self.assertEncode(array.array('B', [1, 2, 3]), "83010203")
+        self.assertEncode(array.array('H', [1, 2]), "8401000200")
+
+    def test_chunked_bytes_string(self):
+        self.assertEncode(io.BytesIO(b'\x01\x02\x03'), "108301020301")
+        self.assertDecode("108301020301", b'\x01\x02\x03')
+        self.assertDecode("10810182020301", b'\x01\x02\x03')
+        self.assertDecode("1001", b'')
+
+        self.assertEncode(io.StringIO('hello'), "118568656c6c6f01")
+        self.assertDecode("118568656c6c6f01", 'hello')
+        self.assertDecode("1101", '')
+
+        # large values are written in multiple chunks
+        data = bytes(range(256)) * 1000
+        text = 'a' + '\U0001F600' * 20000
+        enc = encode_as_bytes({'data': io.BytesIO(data), 'text': io.StringIO(text), 'n': 1})
+        self.assertEqual({'data': data, 'text': text, 'n': 1}, decode_bytes(enc))
+        with io.BufferedReader(io.BytesIO(enc)) as stream:
+            self.assertEqual({'data': data, 'text': text, 'n': 1}, decode_stream(stream))
+
+        # streaming read of the chunks
+        enc = encode_as_bytes(io.BytesIO(data))
+        chunks = list(YajbeBufferDecoder(enc).decode_chunks())
+        self.assertEqual(4, len(chunks))
+        self.assertEqual(data, b''.join(chunks))
+        self.assertEqual([b'abc'], list(YajbeBufferDecoder(bytes.fromhex("83616263")).decode_chunks()))
+
+    def test_blob_refs(self):
+        # sidecar stream: the blobs are appended while the document is encoded
+        sidecar = io.BytesIO()
+        data = bytes([7]) * 100
+        enc = encode_as_bytes({'a': data, 'b': b'\x01\x02'}, blob_writer=YajbeBlobWriter(64, sidecar))
+        self.assertEqual("3281611260584b8162820102", enc.hex())
+        self.assertEqual(data, sidecar.getvalue())
+        dec = decode_bytes(enc, blobs=sidecar.getvalue())
+        self.assertIsInstance(dec['a'], memoryview)
+        self.assertEqual({'a': data, 'b': b'\x01\x02'}, dec)
+        with self.assertRaises(Exception):
+            decode_bytes(enc)
+
+        # deferred: the blob region is written after the document, in the same buffer
+        blob_writer = YajbeBlobWriter(128)
+        value = {'name': 'bar', 'thumb': bytes(range(200)), 'data': bytes(range(256)) * 20}
+        with io.BytesIO() as stream:
+            encode_to_stream(stream, value, blob_writer=blob_writer)
+            doc_length = stream.tell()
+            blob_writer.write_to(stream)
+            file = stream.getvalue()
+        self.assertEqual(doc_length + 200 + 5120, len(file))
+        region = memoryview(file)[doc_length:]
+        self.assertEqual(value, decode_bytes(file[:doc_length], blobs=region))
+
+    def test_embedded_document(self):
+        payload = YajbeDocument(encode_as_bytes({'x': 1}))
+        self.assertEqual("31817840", payload.data.hex())
+
+        # the payload is written as-is, with its own field names
+        enc = encode_as_bytes({'id': 'a', 'payload': payload})
+        self.assertEqual("32826964c161877061796c6f6164138431817840", enc.hex())
+
+        dec = decode_bytes(enc)
+        self.assertIsInstance(dec['payload'], YajbeDocument)
+        self.assertEqual(payload, dec['payload'])
+        self.assertEqual({'x': 1}, dec['payload'].decode())
+        with io.BufferedReader(io.BytesIO(enc)) as stream:
+            self.assertEqual({'x': 1}, decode_stream(stream)['payload'].decode())
+
+        # the same fragment is spliced many times without encoding it again
+        value = {'name': 'foo', 'tags': ['a', 'b']}
+        doc = YajbeDocument(encode_as_bytes(value))
+        dec = decode_bytes(encode_as_bytes([doc, doc, doc]))
+        self.assertEqual([value, value, value], [item.decode() for item in dec])
+
+    def test_reset_marker(self):
+        # streaming array, the field names are reset before the third item
+        self.assertDecode("2f3f816140013fa04101143f8161420101", [{'a': 1}, {'a': 2}, {'a': 3}])
+        # after the reset the index 0 is the first field name seen after it
+        self.assertDecode("2f3f8161400114" + "3f816241013fa0420101", [{'a': 1}, {'b': 2}, {'b': 3}])
+
+    def test_sized_containers(self):
+        # {"a": {"b": 1}, "b": 2} with the inner map sized, the "b" indexed inside is dropped at the end of it
+        self.assertDecode("3f8161154331816240816241" + "01", {'a': {'b': 1}, 'b': 2})
+        # the index 1 is "d", the "c" indexed inside the sized map was dropped
+        self.assertDecode("24" + "31816140" + "1545" + "32a041816342" + "31816443" + "31a144",
+                          [{'a': 1}, {'a': 2, 'c': 3}, {'d': 4}, {'d': 5}])
+        # zero length: written when the encoder buffer was full, not skippable
+        self.assertDecode("21" + "1560" + "2f4001", [[1]])
+
+    @unittest.skipIf(numpy is None, 'numpy not available')
+    def test_numpy_arrays(self):
+        f64 = numpy.array([1.5, -4.1, 1.0e+300])
+        enc = encode_as_bytes(f64)
+        self.assertEqual(encode_as_bytes([1.5, -4.1, 1.0e+300]), enc)
+        dec = decode_bytes(enc, numpy_arrays=True)
+        self.assertIsInstance(dec, numpy.ndarray)
+        self.assertTrue(numpy.array_equal(f64, dec))
+
+        f32 = numpy.arange(100, dtype=numpy.float32)
+        enc = encode_as_bytes({'embedding': f32})
+        self.assertEqual(bytes.fromhex("3189") + b"embedding" + bytes.fromhex("2b5a05"), enc[:14])
+        dec = decode_bytes(enc, numpy_arrays=True)
+        self.assertEqual(numpy.float32, dec['embedding'].dtype)
+        self.assertTrue(numpy.array_equal(f32, dec['embedding']))
+        self.assertEqual(list(range(100)), decode_bytes(enc)['embedding'])
+
+        ints = decode_bytes(encode_as_bytes(numpy.array([1, -2, 300])), numpy_arrays=True)
+        self.assertEqual(numpy.int64, ints.dtype)
+        self.assertEqual([1, -2, 300], ints.tolist())
+
+        mixed = decode_bytes(encode_as_bytes([1, 'a', 2.5]), numpy_arrays=True)
+        self.assertEqual([1, 'a', 2.5], mixed)
+
+        # numpy scalars are encoded as the python values
+        scalars = {'f': numpy.float32(0.5), 'i': numpy.int64(5), 'b': numpy.bool_(True)}
+        self.assertEqual(encode_as_bytes({'f': 0.5, 'i': 5, 'b': True}), encode_as_bytes(scalars))
+        self.assertEqual({'f': 0.5, 'i': 5, 'b': True}, decode_bytes(encode_as_bytes(scalars)))
+        self.assertEqual([0.5, 5, False], decode_bytes(encode_as_bytes([numpy.float64(0.5), numpy.int32(5), numpy.bool_(False)])))
+
     def test_map_simple(self):
         self.assertEncodeDecode({}, "30")
         self.assertEncode({}, "30")
@@ -190,6 +331,15 @@ class TestYajbe(unittest.TestCase):
         dec2x = decode_bytes(bytes.fromhex("3fa141a0408d736f6d657468696e67206e65774201"), INITIAL_FIELDS)
         self.assertEqual(input, dec2x)
 
+    def test_map_int_keys(self):
+        self.assertEncodeDecode({1: 'a'}, "3140c161")
+        self.assertEncodeDecode({0: 0, 1000: 'k'}, "32606059cf03c16b")
+        self.assertEncodeDecode({1: 'a', 'x': 2, -5: True}, "3340c1618178416503")
+        self.assertDecode("3f40c16101", {1: 'a'})
+
+        # int keys are not indexed and do not touch the prefix state
+        self.assertEncodeDecode({'aaaaaa': 1, 10: 2, 'aaaaab': 3}, "3386616161616161404941c1056242")
+
     def test_data_set_encode_decode(self):
         import hashlib
         import json
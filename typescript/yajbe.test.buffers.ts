@@ -0,0 +1,66 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the 'License'); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an 'AS IS' BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import { assertEquals } from 'https://deno.land/std/testing/asserts.ts';
+import * as YAJBE from './yajbe.ts';
+
+Deno.test('bufferPool.testSizeClass', () => {
+  const pool = new YAJBE.BufferPool();
+  assertEquals(pool.alloc(1).length, 1024);
+  assertEquals(pool.alloc(1024).length, 1024);
+  assertEquals(pool.alloc(1025).length, 2048);
+  assertEquals(pool.alloc(8192).length, 8192);
+  assertEquals(pool.alloc(1 << 20).length, 1 << 20);
+  // above the largest class the buffer has the exact size, and it is not pooled
+  const large = pool.alloc((1 << 20) + 1);
+  assertEquals(large.length, (1 << 20) + 1);
+  pool.release(large);
+  assertEquals(pool.alloc((1 << 20) + 1) === large, false);
+
+  const buf = pool.alloc(4000);
+  pool.release(buf);
+  assertEquals(pool.alloc(4096) === buf, true);
+});
+
+Deno.test('writer.testChunkChain', () => {
+  const writer = new YAJBE.InMemoryBytesWriter(16);
+  const expected: number[] = [];
+  for (let i = 0; i < 5000; ++i) {
+    writer.writeUint8(i & 0xff);
+    expected.push(i & 0xff);
+    if ((i % 7) === 0) {
+      writer.writeUint32(i);
+      expected.push(i & 0xff, (i >> 8) & 0xff, (i >> 16) & 0xff, (i >> 24) & 0xff);
+    }
+  }
+  writer.writeUint8Array(new Uint8Array(3000).fill(7));
+  for (let i = 0; i < 3000; ++i) expected.push(7);
+
+  assertEquals(writer.size(), expected.length);
+  assertEquals(Array.from(writer.slice()), expected);
+  writer.release();
+});
+
+Deno.test('encode.testSizeHint', () => {
+  const sizeHint = new YAJBE.EncodeSizeHint();
+  const input = { data: new Uint8Array(100_000).fill(1), items: Array.from({ length: 1000 }, (_, i) => ({ id: i + 1 })) };
+  for (let i = 0; i < 3; ++i) {
+    const enc = YAJBE.encode(input, { sizeHint });
+    assertEquals(sizeHint.capacity() >= enc.length, true);
+    assertEquals(YAJBE.decode(enc), input);
+  }
+});
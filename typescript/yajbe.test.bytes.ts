@@ -15,7 +15,7 @@
  * limitations under the License.
  */
 
-import { assertEquals } from 'https://deno.land/std/testing/asserts.ts';
+import { assertEquals, assertThrows } from 'https://deno.land/std/testing/asserts.ts';
 import * as hex from 'https://deno.land/std@0.178.0/encoding/hex.ts';
 import * as YAJBE from './yajbe.ts';
 
@@ -74,3 +74,50 @@ Deno.test('testRandEncodeDecode', () => {
     assertEquals(input, YAJBE.decode(enc));
   }
 });
+
+Deno.test('testChunked', () => {
+  const hexOf = (data: Uint8Array) => new TextDecoder().decode(hex.encode(data));
+  const fromHex = (text: string) => hex.decode(new TextEncoder().encode(text));
+
+  assertEquals(hexOf(YAJBE.encode(new YAJBE.ChunkedBytes([new Uint8Array([1]), new Uint8Array([2, 3])]))), "10810182020301");
+  assertEquals(YAJBE.decode(fromHex("10810182020301")), new Uint8Array([1, 2, 3]));
+  assertEquals(YAJBE.decode(fromHex("1001")), new Uint8Array(0));
+
+  assertEquals(hexOf(YAJBE.encode(new YAJBE.ChunkedString(['hel', 'lo']))), "118368656c826c6f01");
+  assertEquals(YAJBE.decode(fromHex("118568656c6c6f01")), 'hello');
+  assertEquals(YAJBE.decode(fromHex("1101")), '');
+
+  // a multi-byte char split across two chunks
+  assertEquals(YAJBE.decode(fromHex("1182f09f82988001")), '\u{1F600}');
+
+  // nested in a map, and streaming read of the chunks
+  const chunks = [new Uint8Array(100).fill(1), new Uint8Array(200).fill(2)];
+  const enc = YAJBE.encode({ data: new YAJBE.ChunkedBytes(chunks), n: 1 });
+  assertEquals(YAJBE.decode(enc), { data: new Uint8Array([...chunks[0], ...chunks[1]]), n: 1 });
+
+  const decoder = new YAJBE.YajbeDecoder(new YAJBE.InMemoryBytesReader(YAJBE.encode(new YAJBE.ChunkedBytes(chunks))));
+  assertEquals(Array.from(decoder.decodeChunks()), chunks);
+});
+
+Deno.test('testBlobRefs', () => {
+  const hexOf = (data: Uint8Array) => new TextDecoder().decode(hex.encode(data));
+
+  const blobWriter = new YAJBE.YajbeBlobWriter(64);
+  const data = new Uint8Array(100).fill(7);
+  const enc = YAJBE.encode({ a: data, b: new Uint8Array([1, 2]) }, { blobWriter });
+  assertEquals(hexOf(enc), "3281611260584b8162820102");
+  assertEquals(blobWriter.size(), 100);
+
+  const blobs = blobWriter.slice();
+  assertEquals(blobWriter.size(), 0);
+  const dec = YAJBE.decode<{ a: Uint8Array, b: Uint8Array }>(enc, { blobs });
+  assertEquals(dec, { a: data, b: new Uint8Array([1, 2]) });
+  assertEquals(dec.a.buffer, blobs.buffer);
+
+  assertThrows(() => YAJBE.decode(enc));
+
+  // chunks are never moved to the blob region
+  const chunked = YAJBE.encode(new YAJBE.ChunkedBytes([data]), { blobWriter });
+  assertEquals(blobWriter.size(), 0);
+  assertEquals(YAJBE.decode(chunked), data);
+});
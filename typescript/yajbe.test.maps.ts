@@ -15,7 +15,7 @@
  * limitations under the License.
  */
 
-import { assertEquals } from 'https://deno.land/std/testing/asserts.ts';
+import { assertEquals, assertThrows } from 'https://deno.land/std/testing/asserts.ts';
 import * as hex from 'https://deno.land/std@0.178.0/encoding/hex.ts';
 import * as YAJBE from './yajbe.ts';
 
@@ -99,6 +99,36 @@ Deno.test("map.testProvidedFields", () => {
   assertEquals(obj2, dec2x);
 });
 
+Deno.test("map.testIntKeys", () => {
+  const input = new Map<unknown, unknown>();
+  input.set(1, 'a');
+  assertEncodeDecode(input, "3140c161");
+  assertDecode("3f40c16101", new Map([[1, 'a']]));
+  assertDecode("3140c161", new Map([[1, 'a']]));
+
+  // int keys are not indexed and do not touch the prefix state
+  const mixed = new Map<unknown, unknown>([['aaaaaa', 1], [10, 2], ['aaaaab', 3]]);
+  assertEncodeDecode(mixed, "3386616161616161404941c1056242");
+
+  // string keys only, a plain object
+  assertDecode("32816140816241", {a: 1, b: 2});
+});
+
+Deno.test("map.testShapes", () => {
+  const ab = {a: 1, b: 2};
+  const abc = {a: 1, b: 2, c: 3};
+  // same first key with different shapes, prefixes and longer objects
+  const input = [ab, ab, {a: 1, c: 2}, ab, abc, ab, {a: 1}, abc, {b: {a: 1, b: [ab]}, a: 2}, ab];
+  assertEquals(YAJBE.decode(YAJBE.encode(input)), input);
+
+  // eof objects, shorter and diverging from the cached shape
+  assertDecode("243f81614081624101" + "3fa040a14101" + "3fa04001" + "3fa04081634201", [ab, ab, {a: 1}, {a: 1, c: 3}]);
+
+  // the decoded objects keep the key order of the encoded data
+  const dec = YAJBE.decode<Record<string, number>[]>(YAJBE.encode([ab, {b: 1, a: 2}, ab]));
+  assertEquals(dec.map((v) => Object.keys(v)), [['a', 'b'], ['b', 'a'], ['a', 'b']]);
+});
+
 Deno.test("testRand", () => {
   for (let k = 0; k < 32; ++k) {
     const input = new Map();
@@ -131,3 +161,52 @@ function generateFieldName(minLength: number, maxLength: number): string {
   }
   return builder.join('');
 }
+
+Deno.test('map.testEmbeddedDocument', () => {
+  const hexOf = (data: Uint8Array) => new TextDecoder().decode(hex.encode(data));
+
+  const payload = YAJBE.YajbeDocument.encode({ x: 1 });
+  assertEquals(hexOf(payload.data), "31817840");
+
+  // the payload is written as-is, with its own field names
+  const enc = YAJBE.encode({ id: 'a', payload });
+  assertEquals(hexOf(enc), "32826964c161877061796c6f6164138431817840");
+
+  const dec = YAJBE.decode<{ id: string, payload: YAJBE.YajbeDocument }>(enc);
+  assertEquals(dec.payload instanceof YAJBE.YajbeDocument, true);
+  assertEquals(dec.payload.data, payload.data);
+  assertEquals(dec.payload.decode(), { x: 1 });
+
+  // the same fragment is spliced many times without encoding it again
+  const value = { name: 'foo', tags: ['a', 'b'] };
+  const doc = YAJBE.YajbeDocument.encode(value);
+  const docs = YAJBE.decode<YAJBE.YajbeDocument[]>(YAJBE.encode([doc, doc, doc]));
+  assertEquals(docs.map((item) => item.decode()), [value, value, value]);
+
+  // the decode with options is not cached, the field name index 0 is resolved by each call
+  const fromHex = (text: string) => hex.decode(new TextEncoder().encode(text));
+  const indexed = new YAJBE.YajbeDocument(fromHex("31a040"));
+  assertEquals(indexed.decode({ fieldNames: ['x'] }), { x: 1 });
+  assertEquals(indexed.decode({ fieldNames: ['y'] }), { y: 1 });
+
+  // the embedded document must be followed by a bytes head
+  assertThrows(() => YAJBE.decode(fromHex("1340")), Error, 'expected bytes for the embedded document');
+});
+
+Deno.test('map.testResetMarker', () => {
+  const fromHex = (text: string) => hex.decode(new TextEncoder().encode(text));
+
+  // streaming array, the field names are reset before the third item
+  assertEquals(YAJBE.decode(fromHex("2f3f816140013fa04101143f8161420101")), [{ a: 1 }, { a: 2 }, { a: 3 }]);
+  // after the reset the index 0 is the first field name seen after it (and the shapes are dropped)
+  assertEquals(YAJBE.decode(fromHex("2f3f816140013fa04101143f816241013fa0420101")), [{ a: 1 }, { a: 2 }, { b: 2 }, { b: 3 }]);
+});
+
+Deno.test('map.testSizedContainers', () => {
+  const fromHex = (text: string) => hex.decode(new TextEncoder().encode(text));
+
+  // the "b" indexed inside the sized map is dropped at the end of it
+  assertEquals(YAJBE.decode(fromHex("3f816115433181624081624101")), { a: { b: 1 }, b: 2 });
+  // the index 1 is "d", the "c" indexed inside the sized map was dropped
+  assertEquals(YAJBE.decode(fromHex("24" + "31816140" + "1545" + "32a041816342" + "31816443" + "31a144")), [{ a: 1 }, { a: 2, c: 3 }, { d: 4 }, { d: 5 }]);
+});
@@ -27,26 +27,124 @@ export interface YajbeEncoderEnumConfig {
 
 export interface YajbeEncoderOptions {
   bufSize?: number;
+  sizeHint?: EncodeSizeHint;
   sortKeys?: boolean;
   fieldNames?: string[];
   enumConfig?: YajbeEncoderEnumConfig;
+  blobWriter?: YajbeBlobWriter;
 };
 
 export function encode(value: unknown, options?: YajbeEncoderOptions): Uint8Array {
-  const writer = new InMemoryBytesWriter(options?.bufSize);
-  const encoder = new YajbeEncoder(writer, options);
-  encoder.encodeItem(value);
-  encoder.flush();
-  return writer.slice();
+  const sizeHint = options?.sizeHint ?? DEFAULT_ENCODE_SIZE_HINT;
+  const writer = new InMemoryBytesWriter(options?.bufSize ?? sizeHint.capacity());
+  try {
+    const encoder = new YajbeEncoder(writer, options);
+    encoder.encodeItem(value);
+    encoder.flush();
+    sizeHint.update(writer.size());
+    return writer.slice();
+  } finally {
+    writer.release();
+  }
 }
 
-export function decode<T>(data: Uint8Array, options?: { fieldNames?: string[] }): T {
+export function decode<T>(data: Uint8Array, options?: { fieldNames?: string[], blobs?: Uint8Array }): T {
   const reader = new InMemoryBytesReader(data);
-  const decoder = new YajbeDecoder(reader, options?.fieldNames);
+  const decoder = new YajbeDecoder(reader, options?.fieldNames, options?.blobs);
   return decoder.decodeItem() as T;
 }
 
 // ==============================================================================================================
+/**
+ * Bytes of unknown length (e.g. read from a file or a socket), encoded as a sequence of chunks.
+ */
+export class ChunkedBytes {
+  readonly chunks: Iterable<Uint8Array>;
+
+  constructor(chunks: Iterable<Uint8Array>) {
+    this.chunks = chunks;
+  }
+}
+
+/**
+ * String of unknown length, encoded as a sequence of utf-8 chunks.
+ */
+export class ChunkedString {
+  readonly chunks: Iterable<string>;
+
+  constructor(chunks: Iterable<string>) {
+    this.chunks = chunks;
+  }
+}
+
+/**
+ * An independently encoded document (own field names and enum state), embedded as a length-prefixed value.
+ * The decoder skips it without decoding it, the value is decoded on access.
+ */
+export class YajbeDocument {
+  readonly data: Uint8Array;
+  private value?: unknown;
+  private decoded = false;
+
+  constructor(data: Uint8Array) {
+    this.data = data;
+  }
+
+  static encode(value: unknown, options?: YajbeEncoderOptions): YajbeDocument {
+    return new YajbeDocument(encode(value, options));
+  }
+
+  // only the decode without options is cached, the options may change the result
+  decode<T>(options?: { fieldNames?: string[] }): T {
+    if (options) return decode(this.data, options);
+    if (!this.decoded) {
+      this.value = decode(this.data);
+      this.decoded = true;
+    }
+    return this.value as T;
+  }
+}
+
+/**
+ * Moves the bytes values above the threshold out of the document, into a blob region.
+ * The document contains a blob reference (offset, length) relative to the start of the region,
+ * the region is built with slice() once the document is encoded (e.g. to append it to the same file).
+ */
+export class YajbeBlobWriter {
+  readonly threshold: number;
+  private pending: Uint8Array[] = [];
+  private regionSize = 0;
+
+  constructor(threshold: number) {
+    if (threshold <= 0) throw new Error('expected a threshold greater than zero, got ' + threshold);
+    this.threshold = threshold;
+  }
+
+  size(): number {
+    return this.regionSize;
+  }
+
+  append(data: Uint8Array): number {
+    const offset = this.regionSize;
+    this.pending.push(data);
+    this.regionSize += data.length;
+    return offset;
+  }
+
+  // returns the blob region, the writer is then ready for the next document
+  slice(): Uint8Array {
+    const region = new Uint8Array(this.regionSize);
+    let offset = 0;
+    for (const data of this.pending) {
+      region.set(data, offset);
+      offset += data.length;
+    }
+    this.pending = [];
+    this.regionSize = 0;
+    return region;
+  }
+}
+
 class DataEncoder {
   encodeItem(value: unknown): void {
     if (value === false) {
@@ -78,6 +176,12 @@ class DataEncoder {
           this.encodeMap(value);
         } else if (value instanceof Set) {
           this.encodeSet(value);
+        } else if (value instanceof ChunkedBytes) {
+          this.encodeChunkedBytes(value.chunks);
+        } else if (value instanceof ChunkedString) {
+          this.encodeChunkedString(value.chunks);
+        } else if (value instanceof YajbeDocument) {
+          this.encodeDocument(value.data);
         } else {
           this.encodeObject(value as {[key: string]: unknown});
         }
@@ -136,6 +240,11 @@ class DataEncoder {
   // object/map
   protected encodeObject(_: {[key: string]: unknown}): void { throw new Error("Not implemented"); }
   protected encodeMap(v: Map<unknown, unknown>): void { this.encodeObject(Object.fromEntries(v)); }
+
+  // Chunked Bytes/String
+  encodeChunkedBytes(_: Iterable<Uint8Array>): void { throw new Error("Not implemented"); }
+  encodeChunkedString(_: Iterable<string>): void { throw new Error("Not implemented"); }
+  encodeDocument(_: Uint8Array): void { throw new Error("Not implemented"); }
 }
 
 interface BytesReader {
@@ -364,13 +473,94 @@ class AbstractBytesWriter implements BytesWriter {
   writeUint64(value: number, bigEndian?: boolean): void { return this.writeUint(value, 8, bigEndian); }
 }
 
+// ==============================================================================================================
+//  Buffer Pool
+// ==============================================================================================================
+const BUFFER_POOL_MIN_SHIFT = 10; // 1KiB
+const BUFFER_POOL_MAX_SHIFT = 20; // 1MiB
+const BUFFER_POOL_MAX_FREE = 8;   // free buffers kept for each size class
+
+/**
+ * Pool of power-of-2 sized buffers (1KiB to 1MiB), larger buffers are allocated with the exact size and not pooled.
+ * Each module instance (one per worker/thread) has its own default pool,
+ * so there is no sharing between threads.
+ */
+export class BufferPool {
+  private readonly freeLists: Uint8Array[][] = [];
+
+  constructor() {
+    for (let i = BUFFER_POOL_MIN_SHIFT; i <= BUFFER_POOL_MAX_SHIFT; ++i) {
+      this.freeLists.push([]);
+    }
+  }
+
+  static sizeClass(size: number): number {
+    if (size <= (1 << BUFFER_POOL_MIN_SHIFT)) return 0;
+    const shift = 32 - Math.clz32(size - 1);
+    return Math.min(shift, BUFFER_POOL_MAX_SHIFT) - BUFFER_POOL_MIN_SHIFT;
+  }
+
+  alloc(size: number): Uint8Array {
+    if (size > (1 << BUFFER_POOL_MAX_SHIFT)) return new Uint8Array(size);
+    const sizeClass = BufferPool.sizeClass(size);
+    return this.freeLists[sizeClass].pop() ?? new Uint8Array(1 << (BUFFER_POOL_MIN_SHIFT + sizeClass));
+  }
+
+  release(buffer: Uint8Array): void {
+    if (buffer.length > (1 << BUFFER_POOL_MAX_SHIFT)) return;
+    const sizeClass = BufferPool.sizeClass(buffer.length);
+    if (buffer.length !== (1 << (BUFFER_POOL_MIN_SHIFT + sizeClass))) return;
+
+    const freeList = this.freeLists[sizeClass];
+    if (freeList.length < BUFFER_POOL_MAX_FREE) {
+      freeList.push(buffer);
+    }
+  }
+}
+
+const DEFAULT_BUFFER_POOL = new BufferPool();
+
+/**
+ * Keeps track of the encoded size of the previous calls,
+ * to pick an initial buffer large enough to avoid chaining chunks.
+ * Use one instance per call site (e.g. one per message type).
+ */
+export class EncodeSizeHint {
+  private avgSize = 0;
+  private maxSize = 0;
+
+  capacity(): number {
+    return Math.max(this.maxSize, Math.ceil(this.avgSize * 1.25));
+  }
+
+  update(size: number): void {
+    this.avgSize = (this.avgSize === 0) ? size : ((this.avgSize * 7) + size) / 8;
+    // the max decays, so a single large message does not pin a large capacity
+    this.maxSize = Math.max(size, Math.floor(this.maxSize * 0.9));
+  }
+}
+
+const DEFAULT_ENCODE_SIZE_HINT = new EncodeSizeHint();
+
+/**
+ * Bytes writer backed by a chain of pooled chunks.
+ * Growing allocates a new chunk from the pool, instead of copying the data written so far.
+ */
 export class InMemoryBytesWriter extends AbstractBytesWriter {
+  private readonly pool: BufferPool;
+  private readonly chunks: Uint8Array[] = [];
+  private readonly chunkLengths: number[] = [];
+  private chunksSize: number;
   private buffer: Uint8Array;
+  private view: DataView;
   private offset: number;
 
-  constructor(bufSize: number = 8192) {
+  constructor(bufSize: number = 8192, pool: BufferPool = DEFAULT_BUFFER_POOL) {
     super();
-    this.buffer = new Uint8Array(bufSize);
+    this.pool = pool;
+    this.buffer = pool.alloc(bufSize);
+    this.view = new DataView(this.buffer.buffer, this.buffer.byteOffset, this.buffer.byteLength);
+    this.chunksSize = 0;
     this.offset = 0;
   }
 
@@ -379,43 +569,107 @@ export class InMemoryBytesWriter extends AbstractBytesWriter {
   }
 
   reset(): void {
+    for (const chunk of this.chunks) {
+      this.pool.release(chunk);
+    }
+    this.chunks.length = 0;
+    this.chunkLengths.length = 0;
+    this.chunksSize = 0;
     this.offset = 0;
   }
 
+  /**
+   * Give back the buffers to the pool. The writer must not be used after this call.
+   */
+  release(): void {
+    this.reset();
+    this.pool.release(this.buffer);
+    this.buffer = new Uint8Array(0);
+    this.view = new DataView(this.buffer.buffer);
+  }
+
   slice(): Uint8Array {
-    return this.buffer.slice(0, this.offset);
+    if (this.chunks.length === 0) {
+      return this.buffer.slice(0, this.offset);
+    }
+
+    const result = new Uint8Array(this.size());
+    let resultOffset = 0;
+    for (let i = 0; i < this.chunks.length; ++i) {
+      result.set(this.chunks[i].subarray(0, this.chunkLengths[i]), resultOffset);
+      resultOffset += this.chunkLengths[i];
+    }
+    result.set(this.buffer.subarray(0, this.offset), resultOffset);
+    return result;
   }
 
   size(): number {
-    return this.offset;
+    return this.chunksSize + this.offset;
   }
 
   writeUint8(value: number): void {
-    const offset = this.offset++;
-    if (offset >= this.buffer.length) {
-      this.grow(offset + 64);
+    if (this.offset === this.buffer.length) {
+      this.nextChunk(1);
     }
-    this.buffer[offset] = value;
+    this.buffer[this.offset++] = value;
   }
 
   writeUint8Array(value: Uint8Array | ArrayLike<number> | number[]): void {
-    this.ensureSpace(value.length);
-    this.buffer.set(value, this.offset);
-    this.offset += value.length;
+    if (value.length <= (this.buffer.length - this.offset)) {
+      this.buffer.set(value, this.offset);
+      this.offset += value.length;
+      return;
+    }
+
+    const data = (value instanceof Uint8Array) ? value : Uint8Array.from(value);
+    let dataOffset = 0;
+    while (dataOffset < data.length) {
+      if (this.offset === this.buffer.length) {
+        this.nextChunk(data.length - dataOffset);
+      }
+      const n = Math.min(data.length - dataOffset, this.buffer.length - this.offset);
+      this.buffer.set(data.subarray(dataOffset, dataOffset + n), this.offset);
+      this.offset += n;
+      dataOffset += n;
+    }
   }
 
-  ensureSpace(size: number): void {
-    const requiredLength = this.offset + size;
-    if (requiredLength <= this.buffer.length) return;
+  writeUint(value: number, width: number, bigEndian?: boolean): void {
+    this.ensureSpace(width);
+    encodeInt(this.buffer, this.offset, value, width, bigEndian);
+    this.offset += width;
+  }
+
+  writeFloat32(value: number, bigEndian?: boolean): void {
+    this.ensureSpace(4);
+    this.view.setFloat32(this.offset, value, !bigEndian);
+    this.offset += 4;
+  }
 
-    // resize with 64bytes alignment
-    this.grow((requiredLength + (64 - 1)) & -64);
+  writeFloat64(value: number, bigEndian?: boolean): void {
+    this.ensureSpace(8);
+    this.view.setFloat64(this.offset, value, !bigEndian);
+    this.offset += 8;
   }
 
-  grow(newLength: number): void {
-    const newBuffer = new Uint8Array(newLength);
-    newBuffer.set(this.buffer);
-    this.buffer = newBuffer;
+  /**
+   * Make sure that the next size bytes can be written contiguously.
+   */
+  ensureSpace(size: number): void {
+    if ((this.offset + size) > this.buffer.length) {
+      this.nextChunk(size);
+    }
+  }
+
+  private nextChunk(minSize: number): void {
+    this.chunks.push(this.buffer);
+    this.chunkLengths.push(this.offset);
+    this.chunksSize += this.offset;
+
+    const chunkSize = Math.max(minSize, Math.min(this.buffer.length * 2, 1 << BUFFER_POOL_MAX_SHIFT));
+    this.buffer = this.pool.alloc(chunkSize);
+    this.view = new DataView(this.buffer.buffer, this.buffer.byteOffset, this.buffer.byteLength);
+    this.offset = 0;
   }
 }
 
@@ -427,6 +681,7 @@ export class YajbeEncoder extends DataEncoder {
 
   private readonly sortKeys: boolean;
   private readonly enumConfig?: YajbeEncoderEnumConfig;
+  private readonly blobWriter?: YajbeBlobWriter;
   private enumMapping?: EnumLruMapping;
 
   constructor(writer: BytesWriter, options?: YajbeEncoderOptions) {
@@ -436,6 +691,7 @@ export class YajbeEncoder extends DataEncoder {
     this.writer = writer;
     this.sortKeys = options?.sortKeys ?? false;
     this.enumConfig = options?.enumConfig;
+    this.blobWriter = options?.blobWriter;
   }
 
   flush(): void {
@@ -491,6 +747,23 @@ export class YajbeEncoder extends DataEncoder {
     }
   }
 
+  protected encodeMap(map: Map<unknown, unknown>): void {
+    const keys = Array.from(map.keys());
+    if (this.sortKeys) keys.sort();
+
+    this.writeLength(0b0011_0000, 10, keys.length);
+    for (let i = 0; i < keys.length; ++i) {
+      const key = keys[i];
+      if (Number.isSafeInteger(key)) {
+        // integer keys are written as int items, not as decimal strings
+        this.encodeInteger(key as number);
+      } else {
+        this.fieldNameWriter.encodeString(String(key));
+      }
+      this.encodeItem(map.get(key));
+    }
+  }
+
   protected encodeArray(value: ArrayLike<unknown>): void {
     this.writeLength(0b0010_0000, 10, value.length);
     for (let i = 0; i < value.length; ++i) {
@@ -499,6 +772,23 @@ export class YajbeEncoder extends DataEncoder {
   }
 
   protected encodeUint8Array(value: Uint8Array): void {
+    if (this.blobWriter && value.length >= this.blobWriter.threshold) {
+      // blob reference: head, int offset, int length
+      this.writer.writeUint8(0b00010010);
+      this.encodeInteger(this.blobWriter.append(value));
+      this.encodeInteger(value.length);
+      return;
+    }
+    this.writeBytes(value);
+  }
+
+  // the document is already encoded, written as-is: head, bytes
+  encodeDocument(data: Uint8Array): void {
+    this.writer.writeUint8(0b00010011);
+    this.writeBytes(data);
+  }
+
+  private writeBytes(value: Uint8Array): void {
     this.writeLength(0b10_000000, 59, value.length);
     this.writer.writeUint8Array(value);
   }
@@ -513,6 +803,23 @@ export class YajbeEncoder extends DataEncoder {
     this.writer.writeUint8Array(utf8data);
   }
 
+  // the length is not known upfront: head (0x10 bytes, 0x11 string), bytes chunks..., EOF
+  encodeChunkedBytes(chunks: Iterable<Uint8Array>): void {
+    this.writer.writeUint8(0b00010000);
+    for (const chunk of chunks) {
+      if (chunk.length > 0) this.writeBytes(chunk);
+    }
+    this.writer.writeUint8(0b00000001);
+  }
+
+  encodeChunkedString(chunks: Iterable<string>): void {
+    this.writer.writeUint8(0b00010001);
+    for (const chunk of chunks) {
+      if (chunk.length > 0) this.writeBytes(this.textEncoder.encode(chunk));
+    }
+    this.writer.writeUint8(0b00000001);
+  }
+
   private writeStringOrEnum(text: string): boolean {
     if (!this.enumMapping) this.newEnumMapping();
 
@@ -566,11 +873,13 @@ export class YajbeDecoder {
   private readonly fieldNameReader: FieldNameReader;
   private readonly textDecoder: TextDecoder;
   private readonly buffer: BytesReader;
+  private readonly blobs?: Uint8Array;
 
-  constructor(buffer: BytesReader, initialFieldNames?: string[]) {
+  constructor(buffer: BytesReader, initialFieldNames?: string[], blobs?: Uint8Array) {
     this.textDecoder = new TextDecoder();
     this.fieldNameReader = new FieldNameReader(buffer, this.textDecoder, initialFieldNames);
     this.buffer = buffer;
+    this.blobs = blobs;
   }
 
   decodeItem(): unknown {
@@ -586,6 +895,21 @@ export class YajbeDecoder {
         return this.decodeObject(head);
       } else if ((head & 0b0010_0000) == 0b0010_0000) {
         return this.decodeArray(head);
+      } else if ((head & 0b0001_0000) == 0b0001_0000) {
+        switch (head) {
+          case 0b00010000: return this.decodeChunkedBytes();
+          case 0b00010001: return this.decodeChunkedString();
+          case 0b00010010: return this.decodeBlobRef();
+          case 0b00010011: return this.decodeEmbeddedDocument();
+          // reset: field names (and the shapes using their indexes) and enum mapping
+          case 0b00010100:
+            this.fieldNameReader.reset();
+            this.shapes.clear();
+            this.enumMapping = undefined;
+            break;
+          case 0b00010101: return this.decodeSizedContainer();
+          default: throw new Error('unsupported item head ' + head.toString(2));
+        }
       } else if ((head & 0b00001_000) == 0b00001_000) {
         switch (head) {
           // enum config
@@ -641,13 +965,102 @@ export class YajbeDecoder {
     return this.buffer.readUint8Array(length);
   }
 
+  private decodeEmbeddedDocument(): YajbeDocument {
+    const head = this.buffer.readUint8();
+    if ((head & 0b11_000000) != 0b10_000000) {
+      throw new Error('expected bytes for the embedded document, got head ' + head.toString(2));
+    }
+    return new YajbeDocument(this.decodeBytes(head));
+  }
+
+  // blob references are returned as a view of the blob region, without copying it
+  private decodeBlobRef(): Uint8Array {
+    const offset = this.decodeInt(this.buffer.readUint8());
+    const length = this.decodeInt(this.buffer.readUint8());
+    if (!this.blobs) {
+      throw new Error('found a blob reference, but no blob region was specified');
+    }
+    if (offset < 0 || length < 0 || (offset + length) > this.blobs.length) {
+      throw new Error('invalid blob reference offset ' + offset + ' length ' + length + ', region size ' + this.blobs.length);
+    }
+    return this.blobs.subarray(offset, offset + length);
+  }
+
   private decodeString(head: number): string {
     const buffer = this.decodeBytes(head);
     const text = this.textDecoder.decode(buffer);
-    this.enumMapping?.add(text);
+    if (this.sizedDepth == 0) this.enumMapping?.add(text);
     return text;
   }
 
+  // sized container: int byte length (used only to skip it), then the array/map.
+  // the field names indexed inside are dropped at the end, and the enum mapping is not used inside
+  private sizedDepth = 0;
+
+  private decodeSizedContainer(): unknown {
+    this.decodeInt(this.buffer.readUint8());
+    const head = this.buffer.readUint8();
+    if ((head & 0b0010_0000) != 0b0010_0000 || (head & 0b11_000000) != 0) {
+      throw new Error('expected array or map after the sized head, got ' + head.toString(2));
+    }
+
+    const scope = this.fieldNameReader.openScope();
+    this.sizedDepth++;
+    const result = ((head & 0b0011_0000) == 0b0011_0000) ? this.decodeObject(head) : this.decodeArray(head);
+    this.sizedDepth--;
+    this.fieldNameReader.closeScope(scope);
+    return result;
+  }
+
+  /**
+   * Streaming read of the next bytes/string item, the chunks are returned as they are read.
+   * A bytes/string item with a known length is returned as a single chunk.
+   */
+  *decodeChunks(): Generator<Uint8Array> {
+    const head = this.buffer.readUint8();
+    if (head == 0b00010000 || head == 0b00010001) {
+      yield* this.readChunks();
+    } else if ((head & 0b10_000000) == 0b10_000000) {
+      yield this.decodeBytes(head);
+    } else {
+      throw new Error('expected bytes or string, got head ' + head.toString(2));
+    }
+  }
+
+  private *readChunks(): Generator<Uint8Array> {
+    while (true) {
+      const head = this.buffer.readUint8();
+      if (head == 0b00000001) return;
+      if ((head & 0b11_000000) != 0b10_000000) {
+        throw new Error('unexpected chunk head ' + head.toString(2));
+      }
+      yield this.decodeBytes(head);
+    }
+  }
+
+  private decodeChunkedBytes(): Uint8Array {
+    const chunks = Array.from(this.readChunks());
+    if (chunks.length == 1) return chunks[0];
+
+    let length = 0;
+    for (const chunk of chunks) length += chunk.length;
+    const data = new Uint8Array(length);
+    let offset = 0;
+    for (const chunk of chunks) {
+      data.set(chunk, offset);
+      offset += chunk.length;
+    }
+    return data;
+  }
+
+  private decodeChunkedString(): string {
+    let text = '';
+    for (const chunk of this.readChunks()) {
+      text += this.textDecoder.decode(chunk, { stream: true });
+    }
+    return text + this.textDecoder.decode();
+  }
+
   private readHasMore(): boolean {
     if (this.buffer.peekUint8() !== 0b00000001) {
       return true;
@@ -679,24 +1092,82 @@ export class YajbeDecoder {
     return retArray;
   }
 
-  private decodeObject(head: number): {[key: string]: unknown} {
+  // ====================================================================================================
+  //  Object Shapes
+  // ====================================================================================================
+  // Arrays of objects usually repeat the same sequence of field indexes. The shapes are cached by first
+  // field index, and a matching object is created by cloning the shape template (same hidden class,
+  // properties already allocated) and then the values are stored in the existing slots.
+  private readonly shapes = new Map<number, ObjectShape>();
+
+  private decodeObject(head: number): {[key: string]: unknown} | Map<number | string, unknown> {
     const w = head & 0b1111;
-    if (w == 0b1111) {
-      const retObject: {[key: string]: unknown} = {};
-      while (this.readHasMore()) {
-        const key = this.fieldNameReader.decodeString();
+    const eof = (w == 0b1111);
+    const length = eof ? -1 : this.readItemCount(w);
+    if (eof ? !this.readHasMore() : length == 0) {
+      return {};
+    }
+
+    const fieldNames = this.fieldNameReader;
+    let key = fieldNames.decodeString();
+    let shape = this.shapes.get(fieldNames.lastIndex);
+    if (shape !== undefined && length > 0 && shape.indexes.length != length) {
+      shape = undefined;
+    }
+
+    let retObject: {[key: string]: unknown} = shape ? {...shape.template} : {};
+    let retMap: Map<number | string, unknown> | undefined;
+    let indexes: number[] | undefined = shape ? undefined : [];
+    let count = 0;
+    while (true) {
+      if (shape !== undefined && shape.indexes[count] !== fieldNames.lastIndex) {
+        // the object is diverging from the cached shape, keep the fields decoded so far
+        retObject = shape.copyPrefix(retObject, count);
+        indexes = shape.indexes.slice(0, count);
+        shape = undefined;
+      }
+      indexes?.push(fieldNames.lastIndex);
+      if (typeof key === 'number' && retMap === undefined) {
+        // the keys of a plain object are strings, with int keys the object is decoded as a Map
+        retMap = new Map<number | string, unknown>(Object.entries(retObject));
+      }
+      if (retMap !== undefined) {
+        retMap.set(key, this.decodeItem());
+      } else {
         retObject[key] = this.decodeItem();
       }
-      return retObject;
+      count++;
+
+      if (eof ? !this.readHasMore() : count == length) break;
+      key = fieldNames.decodeString();
     }
 
-    const length = this.readItemCount(w);
-    const retObject: {[key: string]: unknown} = {};
-    for (let i = 0; i < length; ++i) {
-      const key = this.fieldNameReader.decodeString();
-      retObject[key] = this.decodeItem();
+    if (shape !== undefined) {
+      // eof object with less fields than the shape
+      if (count < shape.indexes.length) {
+        retObject = shape.copyPrefix(retObject, count);
+      }
+    } else {
+      this.addShape(indexes!);
     }
-    return retObject;
+    return retMap ?? retObject;
+  }
+
+  private addShape(indexes: number[]): void {
+    // inside a sized container the indexes may be dropped at the end of it
+    if (this.sizedDepth > 0) return;
+    if (indexes.length > MAX_SHAPE_FIELDS) return;
+    if (this.shapes.size >= MAX_SHAPES && !this.shapes.has(indexes[0])) return;
+
+    const keys = new Array<string>(indexes.length);
+    for (let i = 0; i < indexes.length; ++i) {
+      // int keys are not indexed
+      if (indexes[i] < 0) return;
+      keys[i] = this.fieldNameReader.keyAt(indexes[i]);
+      // the spread operator does not copy the prototype
+      if (keys[i] === '__proto__') return;
+    }
+    this.shapes.set(indexes[0], new ObjectShape(indexes, keys));
   }
 
 
@@ -853,12 +1324,43 @@ export class FieldNameWriter {
   }
 }
 
+const MAX_SHAPES = 256;
+const MAX_SHAPE_FIELDS = 64;
+
+class ObjectShape {
+  readonly indexes: number[];
+  readonly keys: string[];
+  readonly template: {[key: string]: unknown};
+
+  constructor(indexes: number[], keys: string[]) {
+    this.indexes = indexes;
+    this.keys = keys;
+    this.template = {};
+    for (const key of keys) {
+      this.template[key] = null;
+    }
+  }
+
+  copyPrefix(obj: {[key: string]: unknown}, count: number): {[key: string]: unknown} {
+    const retObject: {[key: string]: unknown} = {};
+    for (let i = 0; i < count; ++i) {
+      const key = this.keys[i];
+      retObject[key] = obj[key];
+    }
+    return retObject;
+  }
+}
+
 export class FieldNameReader {
   private readonly indexedNames: Uint8Array[] = [];
+  private readonly indexedKeys: string[] = [];
   private readonly textDecoder: TextDecoder;
   private readonly reader: BytesReader;
 
   private lastKey: Uint8Array = new Uint8Array(0);
+  private initialCount = 0;
+  // index of the last key decoded, or -1 for int keys
+  lastIndex = -1;
 
   constructor(reader: BytesReader, textDecoder: TextDecoder, initialFieldNames?: string[]) {
     this.reader = reader;
@@ -868,13 +1370,35 @@ export class FieldNameReader {
       const textEncoder = new TextEncoder();
       for (let i = 0; i < initialFieldNames.length && i < 65819; ++i) {
         this.indexedNames.push(textEncoder.encode(initialFieldNames[i]));
+        this.indexedKeys.push(initialFieldNames[i]);
       }
+      this.initialCount = this.indexedNames.length;
     }
   }
 
-  decodeString(): string {
+  // back to the initial state, only the initial field names indexed
+  reset(): void {
+    this.indexedNames.length = this.initialCount;
+    this.indexedKeys.length = this.initialCount;
+    this.lastKey = new Uint8Array(0);
+    this.lastIndex = -1;
+  }
+
+  // sized container: the names indexed inside are dropped at the end of it
+  openScope(): [number, Uint8Array] {
+    return [this.indexedNames.length, this.lastKey];
+  }
+
+  closeScope(scope: [number, Uint8Array]): void {
+    this.indexedNames.length = scope[0];
+    this.indexedKeys.length = scope[0];
+    this.lastKey = scope[1];
+  }
+
+  decodeString(): string | number {
     const head = this.reader.readUint8();
     switch ((head >> 5) & 0b111) {
+      case 0b010: case 0b011: return this.readIntKey(head);
       case 0b100: return this.readFullFieldName(head);
       case 0b101: return this.readIndexedFieldName(head);
       case 0b110: return this.readPrefix(head);
@@ -883,6 +1407,21 @@ export class FieldNameReader {
     }
   }
 
+  keyAt(index: number): string {
+    return this.indexedKeys[index];
+  }
+
+  // int keys are not indexed, and they don't change the last key used by prefix/suffix
+  private readIntKey(head: number): number {
+    this.lastIndex = -1;
+    const signed = (head & 0b011_00000) == 0b011_00000;
+    const w = head & 0b11111;
+    if (w < 24) return signed ? -w : (1 + w);
+
+    const value = this.reader.readUint(w - 23);
+    return signed ? -(value + 24) : (value + 25);
+  }
+
   private readLength(head: number) {
     const length = (head & 0b000_11111);
     if (length < 30) return length;
@@ -894,9 +1433,12 @@ export class FieldNameReader {
   }
 
   private addToIndex(utf8: Uint8Array): string {
+    const key = this.textDecoder.decode(utf8);
+    this.lastIndex = this.indexedNames.length;
     this.indexedNames.push(utf8);
+    this.indexedKeys.push(key);
     this.lastKey = utf8;
-    return this.textDecoder.decode(utf8);
+    return key;
   }
 
   private readFullFieldName(head: number): string {
@@ -907,9 +1449,10 @@ export class FieldNameReader {
 
   private readIndexedFieldName(head: number): string {
     const fieldIndex = this.readLength(head);
-    const utf8 = this.indexedNames[fieldIndex];
-    this.lastKey = utf8;
-    return this.textDecoder.decode(utf8);
+    this.lastKey = this.indexedNames[fieldIndex];
+    this.lastIndex = fieldIndex;
+    // the decoded keys are cached, so the same string instance is reused by every object
+    return this.indexedKeys[fieldIndex];
   }
 
   private readPrefix(head: number): string {